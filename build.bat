@@ -1,6 +1,6 @@
 @echo off
 if not exist build mkdir build
-g++ -std=c++17 -Iinclude src/main.cpp -o build/RaceLogic.exe
+g++ -std=c++17 -pthread -Iinclude src/main.cpp -o build/RaceLogic.exe
 if %errorlevel% neq 0 (
     echo Build Failed!
     exit /b %errorlevel%
@@ -1,5 +1,6 @@
 const app = {
     data: null,
+    laps: {}, // raceId -> { driverId -> typed-array columns }
     currentRaceIndex: 0,
 
     init: function () {
@@ -10,6 +11,11 @@ const app = {
 
         this.data = window.raceData;
 
+        // Optional lap-by-lap telemetry (laps.js)
+        if (window.lapTelemetry) {
+            this.laps = this.decodeLapTelemetry(this.base64ToBytes(window.lapTelemetry));
+        }
+
         // Find last race index as default
         if (this.data.races.length > 0) {
             this.currentRaceIndex = 0; // Start at Race 1
@@ -82,6 +88,70 @@ const app = {
         }
     },
 
+    base64ToBytes: function (b64) {
+        const bin = atob(b64);
+        const bytes = new Uint8Array(bin.length);
+        for (let i = 0; i < bin.length; i++) bytes[i] = bin.charCodeAt(i);
+        return bytes;
+    },
+
+    // Decodes the columnar lap telemetry written by exportLapTelemetryJs
+    // (format described in LapTelemetry.h) into typed arrays per driver.
+    decodeLapTelemetry: function (bytes) {
+        const races = {};
+        if (bytes.length < 5 || String.fromCharCode(bytes[0], bytes[1], bytes[2], bytes[3]) !== "RLLT" || bytes[4] !== 1) {
+            console.warn("Unsupported lap telemetry format");
+            return races;
+        }
+
+        let pos = 5;
+        const varint = () => {
+            let v = 0, mul = 1, b;
+            do {
+                b = bytes[pos++];
+                v += (b & 0x7F) * mul;
+                mul *= 128;
+            } while (b & 0x80);
+            return v;
+        };
+        const signed = () => {
+            const z = varint();
+            return (z % 2) ? -(z + 1) / 2 : z / 2; // Zigzag
+        };
+        // Delta-decodes one column into the given typed array
+        const column = (arr, scale) => {
+            let v = 0;
+            for (let i = 0; i < arr.length; i++) {
+                v += signed();
+                arr[i] = v * scale;
+            }
+            return arr;
+        };
+
+        const raceCount = varint();
+        for (let r = 0; r < raceCount; r++) {
+            const raceId = varint();
+            const driverCount = varint();
+            const drivers = {};
+            for (let d = 0; d < driverCount; d++) {
+                const len = bytes[pos++];
+                const id = String.fromCharCode.apply(null, bytes.subarray(pos, pos + len));
+                pos += len;
+                const n = varint();
+                drivers[id] = {
+                    lap: column(new Uint16Array(n), 1),
+                    lapTime: column(new Float32Array(n), 0.001),
+                    elapsed: column(new Float64Array(n), 0.001),
+                    position: column(new Uint8Array(n), 1),
+                    compound: column(new Uint8Array(n), 1), // 1 S, 2 M, 3 H, 4 I, 5 W
+                    degradation: column(new Uint8Array(n), 1)
+                };
+            }
+            races[raceId] = drivers;
+        }
+        return races;
+    },
+
     getTeamColor: function (team) {
         const colors = {
             "Red Bull": "#3671C6",
@@ -129,6 +199,14 @@ const app = {
         // Header
         this.dom.raceName.textContent = `${race.trackName} Grand Prix`;
         this.dom.currentRaceDisplay.textContent = `Round ${race.raceId}`;
+        const raceLaps = this.laps[race.raceId];
+        if (raceLaps) {
+            let maxLap = 0;
+            Object.values(raceLaps).forEach(d => {
+                if (d.lap.length > 0) maxLap = Math.max(maxLap, d.lap[d.lap.length - 1]);
+            });
+            this.dom.currentRaceDisplay.textContent += ` · ${maxLap} Laps`;
+        }
 
         // Weather
         this.dom.raceWeather.textContent = race.weather || "Sunny";
@@ -173,7 +251,7 @@ const app = {
                 <td style="color: ${isDNF ? '#666' : '#fff'}">${this.formatTime(res.time)}</td>
                 <td><span style="color: var(--accent)">${res.pits}</span></td>
                 <td>
-                    <span style="color: ${res.tyreDegradation < 40 ? '#4caf50' : res.tyreDegradation < 70 ? '#ffeb3b' : '#f44336'}">
+                    <span title="${res.degradationRate !== undefined ? res.degradationRate.toFixed(3) + ' s/lap' : ''}" style="color: ${res.tyreDegradation < 40 ? '#4caf50' : res.tyreDegradation < 70 ? '#ffeb3b' : '#f44336'}">
                         ${res.tyreDegradation}%
                     </span>
                 </td>
@@ -0,0 +1,307 @@
+#ifndef BATTLE_MATRIX_H
+#define BATTLE_MATRIX_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BATTLE_MATRIX_SSE2 1
+#endif
+
+// Head-to-head summary of driver A against driver B
+struct BattleRecord {
+  int lapsAhead = 0;    // Laps A was classified ahead of B
+  int lapsBehind = 0;
+  int lapsTogether = 0; // Laps both were classified
+  float minGap = std::numeric_limits<float>::infinity(); // Elapsed time
+  int overtakesGained = 0; // A went from behind B to ahead of B
+  int overtakesLost = 0;
+};
+
+// Dense N x N battle counters for one field, updated once per lap from the
+// classification. Cell [i * stride + j] describes driver i against driver j;
+// rows are padded to a multiple of 4 so each row update runs 4 drivers per
+// SSE2 instruction (scalar fallback elsewhere).
+class BattleMatrix {
+private:
+  struct LapState {
+    int lap;
+    std::vector<int32_t> pos; // Slot -> Position, -1 = not classified
+    std::vector<float> elapsed;
+  };
+
+  std::vector<std::string> ids;
+  std::vector<std::string> teams;
+  HashMap<std::string, int> slotOf;
+  int stride;
+
+  std::vector<int32_t> ahead;    // Laps i ahead of j
+  std::vector<int32_t> together; // Laps both classified
+  std::vector<float> minGap;     // Smallest |elapsed_i - elapsed_j|
+  std::vector<int32_t> passes;   // Times i passed j
+
+  // Classification per lap, replayed after a live rewind
+  std::vector<LapState> history;
+
+  static int padded(int n) { return (n + 3) & ~3; }
+
+  void clearCounters() {
+    size_t cells = (size_t)stride * stride;
+    ahead.assign(cells, 0);
+    together.assign(cells, 0);
+    minGap.assign(cells, std::numeric_limits<float>::infinity());
+    passes.assign(cells, 0);
+  }
+
+  // One lap: every row against every column. `prev` is the previous lap's
+  // classification (all -1 on the first lap).
+  void applyLap(const int32_t *pos, const float *elapsed, const int32_t *prev) {
+    const int n = (int)ids.size();
+    for (int i = 0; i < n; ++i) {
+      const int32_t pi = pos[i];
+      if (pi < 0)
+        continue;
+      const int32_t qi = prev[i];
+      const float ei = elapsed[i];
+      int32_t *aheadRow = &ahead[(size_t)i * stride];
+      int32_t *togetherRow = &together[(size_t)i * stride];
+      float *gapRow = &minGap[(size_t)i * stride];
+      int32_t *passRow = &passes[(size_t)i * stride];
+      int j = 0;
+#ifdef BATTLE_MATRIX_SSE2
+      const __m128i vpi = _mm_set1_epi32(pi);
+      const __m128i vqi = _mm_set1_epi32(qi);
+      const __m128i none = _mm_set1_epi32(-1);
+      const __m128 vei = _mm_set1_ps(ei);
+      const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+      const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+      for (; j < stride; j += 4) {
+        __m128i pj = _mm_loadu_si128((const __m128i *)(pos + j));
+        __m128i qj = _mm_loadu_si128((const __m128i *)(prev + j));
+        __m128i valid = _mm_cmpgt_epi32(pj, none);
+        __m128i isAhead = _mm_and_si128(_mm_cmplt_epi32(vpi, pj), valid);
+        // Comparison masks are -1, so subtracting adds one per lane
+        __m128i *t = (__m128i *)(togetherRow + j);
+        _mm_storeu_si128(t, _mm_sub_epi32(_mm_loadu_si128(t), valid));
+        __m128i *a = (__m128i *)(aheadRow + j);
+        _mm_storeu_si128(a, _mm_sub_epi32(_mm_loadu_si128(a), isAhead));
+
+        __m128 gap = _mm_and_ps(
+            _mm_sub_ps(vei, _mm_loadu_ps(elapsed + j)), absMask);
+        __m128 validPs = _mm_castsi128_ps(valid);
+        gap = _mm_or_ps(_mm_and_ps(validPs, gap), _mm_andnot_ps(validPs, inf));
+        _mm_storeu_ps(gapRow + j, _mm_min_ps(_mm_loadu_ps(gapRow + j), gap));
+
+        __m128i wasBehind = _mm_and_si128(_mm_cmpgt_epi32(vqi, qj),
+                                          _mm_cmpgt_epi32(qj, none));
+        __m128i passed = _mm_and_si128(wasBehind, isAhead);
+        __m128i *p = (__m128i *)(passRow + j);
+        _mm_storeu_si128(p, _mm_sub_epi32(_mm_loadu_si128(p), passed));
+      }
+#endif
+      for (; j < n; ++j) {
+        const int32_t pj = pos[j];
+        if (pj < 0)
+          continue;
+        togetherRow[j]++;
+        bool isAhead = pi < pj;
+        aheadRow[j] += isAhead;
+        gapRow[j] = std::min(gapRow[j], std::fabs(ei - elapsed[j]));
+        passRow[j] += isAhead && prev[j] >= 0 && qi > prev[j];
+      }
+    }
+  }
+
+  void replay() {
+    clearCounters();
+    std::vector<int32_t> none(stride, -1);
+    const int32_t *prev = none.data();
+    for (const LapState &s : history) {
+      applyLap(s.pos.data(), s.elapsed.data(), prev);
+      prev = s.pos.data();
+    }
+  }
+
+  // Re-lays the matrix out for a larger field (season totals)
+  void grow(int newStride) {
+    int oldStride = stride;
+    int copied = std::min((int)ids.size(), oldStride);
+    std::vector<int32_t> oldAhead, oldTogether, oldPasses;
+    std::vector<float> oldGap;
+    oldAhead.swap(ahead);
+    oldTogether.swap(together);
+    oldGap.swap(minGap);
+    oldPasses.swap(passes);
+    stride = newStride;
+    clearCounters();
+    for (int i = 0; i < copied; ++i) {
+      for (int j = 0; j < copied; ++j) {
+        size_t from = (size_t)i * oldStride + j;
+        size_t to = (size_t)i * stride + j;
+        ahead[to] = oldAhead[from];
+        together[to] = oldTogether[from];
+        minGap[to] = oldGap[from];
+        passes[to] = oldPasses[from];
+      }
+    }
+  }
+
+public:
+  BattleMatrix() : slotOf(64), stride(0) {}
+
+  // New field (drops all counters)
+  void reset(const std::vector<std::string> &driverIds,
+             const std::vector<std::string> &driverTeams) {
+    ids.clear();
+    teams.clear();
+    slotOf.clear();
+    history.clear();
+    stride = padded((int)driverIds.size());
+    for (size_t i = 0; i < driverIds.size(); ++i)
+      addDriver(driverIds[i], i < driverTeams.size() ? driverTeams[i] : "");
+    clearCounters();
+  }
+
+  // Slot of a driver, added (with empty counters) if new
+  int addDriver(const std::string &id, const std::string &team) {
+    const int *slot = slotOf.find(id);
+    if (slot)
+      return *slot;
+    int s = (int)ids.size();
+    slotOf.put(id, s);
+    ids.push_back(id);
+    teams.push_back(team);
+    if ((int)ids.size() > stride)
+      grow(padded((int)ids.size() * 2));
+    return s;
+  }
+
+  int slot(const std::string &id) const {
+    const int *s = slotOf.find(id);
+    return s ? *s : -1;
+  }
+
+  int size() const { return (int)ids.size(); }
+  const std::string &getId(int slot) const { return ids[slot]; }
+  const std::string &getTeam(int slot) const { return teams[slot]; }
+
+  // `order` = classified driver ids after `lap`, P1 first, `elapsed` their
+  // race times. Unknown ids are ignored.
+  void update(int lap, const std::vector<std::string> &order,
+              const std::vector<float> &elapsed) {
+    LapState s;
+    s.lap = lap;
+    s.pos.assign(stride, -1);
+    s.elapsed.assign(stride, 0.0f);
+    for (size_t p = 0; p < order.size(); ++p) {
+      int i = slot(order[p]);
+      if (i < 0)
+        continue;
+      s.pos[i] = (int32_t)p;
+      s.elapsed[i] = elapsed[p];
+    }
+    std::vector<int32_t> none;
+    const int32_t *prev;
+    if (history.empty()) {
+      none.assign(stride, -1);
+      prev = none.data();
+    } else {
+      prev = history.back().pos.data();
+    }
+    applyLap(s.pos.data(), s.elapsed.data(), prev);
+    history.push_back(std::move(s));
+  }
+
+  // Forgets every lap after `lap` (live rewind) and recomputes the rest
+  void truncateAfter(int lap) {
+    size_t keep = history.size();
+    while (keep > 0 && history[keep - 1].lap > lap)
+      keep--;
+    if (keep == history.size())
+      return;
+    history.resize(keep);
+    replay();
+  }
+
+  // Frees the per-lap classification (truncateAfter no longer possible)
+  void dropHistory() { std::vector<LapState>().swap(history); }
+
+  // Adds another matrix's counters (e.g. one race into the season)
+  void accumulate(const BattleMatrix &other) {
+    std::vector<int> map(other.ids.size());
+    for (size_t i = 0; i < other.ids.size(); ++i)
+      map[i] = addDriver(other.ids[i], other.teams[i]);
+    for (int i = 0; i < (int)other.ids.size(); ++i) {
+      for (int j = 0; j < (int)other.ids.size(); ++j) {
+        size_t from = (size_t)i * other.stride + j;
+        size_t to = (size_t)map[i] * stride + map[j];
+        ahead[to] += other.ahead[from];
+        together[to] += other.together[from];
+        minGap[to] = std::min(minGap[to], other.minGap[from]);
+        passes[to] += other.passes[from];
+      }
+    }
+  }
+
+  BattleRecord get(int a, int b) const {
+    BattleRecord r;
+    if (a < 0 || b < 0 || a == b)
+      return r;
+    size_t ab = (size_t)a * stride + b;
+    size_t ba = (size_t)b * stride + a;
+    r.lapsAhead = ahead[ab];
+    r.lapsBehind = ahead[ba];
+    r.lapsTogether = together[ab];
+    r.minGap = minGap[ab];
+    r.overtakesGained = passes[ab];
+    r.overtakesLost = passes[ba];
+    return r;
+  }
+
+  BattleRecord get(const std::string &a, const std::string &b) const {
+    return get(slot(a), slot(b));
+  }
+
+  // func(slotA, slotB, record) for every pair that shared the track, A < B
+  template <typename Func> void forEachPair(Func func) const {
+    for (int a = 0; a < (int)ids.size(); ++a) {
+      for (int b = a + 1; b < (int)ids.size(); ++b) {
+        BattleRecord r = get(a, b);
+        if (r.lapsTogether > 0)
+          func(a, b, r);
+      }
+    }
+  }
+
+  // Same, restricted to drivers of the same team
+  template <typename Func> void forEachTeammatePair(Func func) const {
+    forEachPair([&](int a, int b, const BattleRecord &r) {
+      if (!teams[a].empty() && teams[a] == teams[b])
+        func(a, b, r);
+    });
+  }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(vectorHeap(ahead) + vectorHeap(together) + vectorHeap(minGap) +
+              vectorHeap(passes),
+          ahead.size());
+    u.add(slotOf.footprint() + vectorHeap(ids) + vectorHeap(teams) +
+          vectorHeap(history));
+    for (size_t i = 0; i < ids.size(); ++i)
+      u.add(stringHeap(ids[i]) * 2 + stringHeap(teams[i]));
+    for (const LapState &s : history)
+      u.add(vectorHeap(s.pos) + vectorHeap(s.elapsed), 1);
+    return u;
+  }
+};
+
+#endif // BATTLE_MATRIX_H
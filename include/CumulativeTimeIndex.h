@@ -0,0 +1,194 @@
+#ifndef CUMULATIVE_TIME_INDEX_H
+#define CUMULATIVE_TIME_INDEX_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Per-race prefix sums of elapsed time (lap + pit time) for every driver.
+// Each lap is recorded once and then finalized into an order sorted by
+// elapsed time, after which:
+//   getCumulativeTime / getGapToLeader / getInterval / getPosition  -> O(1)
+//   getPositionForElapsed                                          -> O(log N)
+class CumulativeTimeIndex {
+private:
+  struct LapOrder {
+    std::vector<int> order;          // Driver slots, fastest elapsed first
+    std::vector<float> sortedTimes;  // Elapsed time, same order as `order`
+    std::vector<int> positionOf;     // Slot -> 0-based position, -1 if absent
+    bool finalized = false;
+  };
+
+  HashMap<std::string, int> driverSlot;
+  std::vector<std::string> driverIds;
+
+  // Slot -> Lap -> Elapsed time (negative when not recorded)
+  std::vector<std::vector<float>> cumulative;
+  std::vector<LapOrder> laps;
+
+  int slotFor(const std::string &driverId) {
+    if (!driverSlot.contains(driverId)) {
+      driverSlot.put(driverId, (int)driverIds.size());
+      driverIds.push_back(driverId);
+      cumulative.emplace_back();
+    }
+    return driverSlot[driverId];
+  }
+
+  // Returns -1 if the driver has no finalized entry on this lap
+  int positionIndex(const std::string &driverId, int lap) const {
+    if (lap < 0 || lap >= (int)laps.size() || !laps[lap].finalized)
+      return -1;
+    const int *slot = driverSlot.find(driverId);
+    if (!slot || *slot >= (int)laps[lap].positionOf.size())
+      return -1;
+    return laps[lap].positionOf[*slot];
+  }
+
+public:
+  CumulativeTimeIndex() : driverSlot(64) {}
+
+  void record(const std::string &driverId, int lap, float elapsed) {
+    int slot = slotFor(driverId);
+    std::vector<float> &row = cumulative[slot];
+    if (lap >= (int)row.size()) {
+      row.resize(lap + 1, -1.0f);
+    }
+    row[lap] = elapsed;
+
+    if (lap >= (int)laps.size()) {
+      laps.resize(lap + 1);
+    }
+    laps[lap].finalized = false;
+  }
+
+  void finalizeLap(int lap) {
+    if (lap < 0 || lap >= (int)laps.size())
+      return;
+    LapOrder &lo = laps[lap];
+    lo.order.clear();
+    lo.sortedTimes.clear();
+    lo.positionOf.assign(driverIds.size(), -1);
+
+    for (int slot = 0; slot < (int)driverIds.size(); ++slot) {
+      if (lap < (int)cumulative[slot].size() && cumulative[slot][lap] >= 0.0f)
+        lo.order.push_back(slot);
+    }
+    // Equal elapsed times are ordered by driver id, independent of the order
+    // drivers were first recorded in
+    std::sort(lo.order.begin(), lo.order.end(), [&](int a, int b) {
+      if (cumulative[a][lap] != cumulative[b][lap])
+        return cumulative[a][lap] < cumulative[b][lap];
+      return driverIds[a] < driverIds[b];
+    });
+    for (size_t i = 0; i < lo.order.size(); ++i) {
+      lo.sortedTimes.push_back(cumulative[lo.order[i]][lap]);
+      lo.positionOf[lo.order[i]] = (int)i;
+    }
+    lo.finalized = true;
+  }
+
+  // Drops every lap after `lap` (used when laps are recomputed)
+  void truncateAfter(int lap) {
+    size_t keep = lap < 0 ? 0 : (size_t)lap + 1;
+    for (auto &row : cumulative) {
+      if (row.size() > keep)
+        row.resize(keep);
+    }
+    if (laps.size() > keep)
+      laps.resize(keep);
+  }
+
+  int getLapCount() const { return (int)laps.size(); }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(driverSlot.footprint() + vectorHeap(driverIds) +
+          vectorHeap(cumulative) + vectorHeap(laps));
+    for (const std::string &id : driverIds)
+      u.add(stringHeap(id) * 2); // Key copy in driverSlot
+    for (const auto &row : cumulative)
+      u.add(vectorHeap(row), row.size());
+    for (const LapOrder &lo : laps)
+      u.add(vectorHeap(lo.order) + vectorHeap(lo.sortedTimes) +
+            vectorHeap(lo.positionOf));
+    return u;
+  }
+
+  bool getCumulativeTime(const std::string &driverId, int lap,
+                         float &out) const {
+    const int *slot = driverSlot.find(driverId);
+    if (!slot)
+      return false;
+    const std::vector<float> &row = cumulative[*slot];
+    if (lap < 0 || lap >= (int)row.size() || row[lap] < 0.0f)
+      return false;
+    out = row[lap];
+    return true;
+  }
+
+  // 1-based position by elapsed time, 0 if not classified on this lap
+  int getPosition(const std::string &driverId, int lap) const {
+    return positionIndex(driverId, lap) + 1;
+  }
+
+  // Seconds behind the car with the least elapsed time (-1 if unknown)
+  float getGapToLeader(const std::string &driverId, int lap) const {
+    int pos = positionIndex(driverId, lap);
+    if (pos < 0)
+      return -1.0f;
+    const std::vector<float> &t = laps[lap].sortedTimes;
+    return t[pos] - t[0];
+  }
+
+  // Seconds behind the car directly ahead (0 for the leader, -1 if unknown)
+  float getInterval(const std::string &driverId, int lap) const {
+    int pos = positionIndex(driverId, lap);
+    if (pos < 0)
+      return -1.0f;
+    if (pos == 0)
+      return 0.0f;
+    const std::vector<float> &t = laps[lap].sortedTimes;
+    return t[pos] - t[pos - 1];
+  }
+
+  // Driver at a 1-based position ("" if none)
+  std::string getDriverAtPosition(int lap, int position) const {
+    if (lap < 0 || lap >= (int)laps.size() || !laps[lap].finalized)
+      return "";
+    const std::vector<int> &order = laps[lap].order;
+    if (position < 1 || position > (int)order.size())
+      return "";
+    return driverIds[order[position - 1]];
+  }
+
+  // 1-based position a car with `elapsed` seconds would hold on this lap
+  int getPositionForElapsed(int lap, float elapsed) const {
+    if (lap < 0 || lap >= (int)laps.size() || !laps[lap].finalized)
+      return 0;
+    const std::vector<float> &t = laps[lap].sortedTimes;
+    return (int)(std::upper_bound(t.begin(), t.end(), elapsed) - t.begin()) +
+           1;
+  }
+
+  // func(lap, position, driverId, elapsed, gapToLeader, interval)
+  template <typename Func> void forEachEntry(Func func) const {
+    for (int lap = 0; lap < (int)laps.size(); ++lap) {
+      const LapOrder &lo = laps[lap];
+      if (!lo.finalized)
+        continue;
+      for (size_t i = 0; i < lo.order.size(); ++i) {
+        float gap = lo.sortedTimes[i] - lo.sortedTimes[0];
+        float interval = i > 0 ? lo.sortedTimes[i] - lo.sortedTimes[i - 1]
+                               : 0.0f;
+        func(lap, (int)i + 1, driverIds[lo.order[i]], lo.sortedTimes[i], gap,
+             interval);
+      }
+    }
+  }
+};
+
+#endif // CUMULATIVE_TIME_INDEX_H
@@ -22,6 +22,7 @@ private:
   float raceTotalTime;
   int tyreAge;
   float tyreDegradation;
+  float degradationRate; // Fitted lap time loss per lap of tyre age (s)
   int stintStartLap;
   int pitStops;
   int overtakes;
@@ -42,7 +43,8 @@ public:
       : id(_id), name(_name), team(_team), baseSpeed(_speed), consistency(0.8f),
         wetWeatherSkill(0.5f), basePitTime(_pitTime), currentLapTime(0.0f),
         lastLapTime(0.0f), raceTotalTime(0.0f), tyreAge(0),
-        tyreDegradation(0.0f), stintStartLap(0), pitStops(0), overtakes(0),
+        tyreDegradation(0.0f), degradationRate(0.0f), stintStartLap(0),
+        pitStops(0), overtakes(0),
         tyreCompound("Soft"), rankingScore(0.0f), consecutiveMissedLaps(0),
         hasParticipated(false), // Initialize hasParticipated
         seasonPoints(0), seasonTotalTime(0.0f) {}
@@ -51,6 +53,8 @@ public:
   std::string getId() const { return id; }
   std::string getName() const { return name; }
   std::string getTeam() const { return team; }
+  float getBaseSpeed() const { return baseSpeed; }
+  float getBasePitTime() const { return basePitTime; }
   float getRankingScore() const { return rankingScore; }
   float getRaceTotalTime() const { return raceTotalTime; }
   int getSeasonPoints() const { return seasonPoints; }
@@ -60,6 +64,7 @@ public:
   int getPitStops() const { return pitStops; }
   int getOvertakes() const { return overtakes; }
   float getTyreDegradation() const { return tyreDegradation; }
+  float getDegradationRate() const { return degradationRate; }
   int getTyreAge() const { return tyreAge; }
   int getStintStartLap() const { return stintStartLap; }
   float getWetWeatherSkill() const { return wetWeatherSkill; }
@@ -85,6 +90,7 @@ public:
     pitStops++;
     tyreAge = 0;
     tyreDegradation = 0.0f;
+    degradationRate = 0.0f;
     hasParticipated = true;
   }
   void resetStint(int lap) { stintStartLap = lap; }
@@ -93,9 +99,14 @@ public:
     hasParticipated = true;
   }
   void setTyreDegradation(float deg) { tyreDegradation = deg; }
+  void setDegradationRate(float rate) { degradationRate = rate; }
   void setTyreCompound(std::string comp) { tyreCompound = comp; }
   void addSeasonPoints(int pts) { seasonPoints += pts; }
   void addSeasonTime(float time) { seasonTotalTime += time; }
+  void restoreSeasonState(int points, float totalTime) {
+    seasonPoints = points;
+    seasonTotalTime = totalTime;
+  }
 
   void incrementMissedLaps() { consecutiveMissedLaps++; }
   void resetMissedLaps() { consecutiveMissedLaps = 0; }
@@ -106,6 +117,7 @@ public:
     raceTotalTime = 0.0f;
     tyreAge = 0;
     tyreDegradation = 0.0f;
+    degradationRate = 0.0f;
     stintStartLap = 0;
     pitStops = 0;
     overtakes = 0;
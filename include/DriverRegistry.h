@@ -2,85 +2,168 @@
 #define DRIVER_REGISTRY_H
 
 #include "Driver.h"
+#include "HashMap.h"
 #include <iostream>
 #include <string>
+#include <vector>
 
-const int TABLE_SIZE =
-    128; // Small size for demo, but enough for F1 grid (20 drivers)
+// Stable reference to a registered driver. A handle goes stale (isValid()
+// returns false) once its driver is removed or replaced, even if the slot is
+// later reused for someone else.
+struct DriverHandle {
+  int slot;
+  unsigned int generation;
+
+  DriverHandle(int s = -1, unsigned int g = 0) : slot(s), generation(g) {}
+  bool isNull() const { return slot < 0; }
+};
 
 class DriverRegistry {
 private:
-  struct Node {
-    Driver *driver;
-    Node *next;
-
-    Node(Driver *d) : driver(d), next(nullptr) {}
+  struct Slot {
+    int denseIndex; // Position in `drivers`, -1 when free
+    unsigned int generation;
   };
 
-  Node *table[TABLE_SIZE];
+  // Dense storage in registration order (linear scan for per-lap iteration)
+  std::vector<Driver *> drivers;
+  std::vector<int> denseToSlot;
+
+  // Sparse slot table backing the handles
+  std::vector<Slot> slots;
+  std::vector<int> freeSlots;
 
-  // Simple Hash Function for strings
-  int hashFunction(const std::string &key) {
-    unsigned long hash = 5381;
-    for (char c : key) {
-      hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+  // DriverID -> Slot
+  HashMap<std::string, int> idToSlot;
+
+  int acquireSlot() {
+    if (!freeSlots.empty()) {
+      int s = freeSlots.back();
+      freeSlots.pop_back();
+      return s;
     }
-    return hash % TABLE_SIZE;
+    slots.push_back({-1, 0});
+    return (int)slots.size() - 1;
   }
 
-public:
-  DriverRegistry() {
-    for (int i = 0; i < TABLE_SIZE; ++i) {
-      table[i] = nullptr;
-    }
+  void releaseSlot(int s) {
+    slots[s].denseIndex = -1;
+    slots[s].generation++; // Invalidate outstanding handles
+    freeSlots.push_back(s);
   }
 
+public:
+  DriverRegistry() : idToSlot(128) {}
+
   ~DriverRegistry() {
-    for (int i = 0; i < TABLE_SIZE; ++i) {
-      Node *current = table[i];
-      while (current != nullptr) {
-        Node *temp = current;
-        current = current->next;
-        delete temp->driver; // Assuming Registry owns the Driver objects
-        delete temp;
-      }
+    for (Driver *d : drivers) {
+      delete d; // Registry owns the Driver objects
     }
   }
 
-  void addDriver(Driver *driver) {
-    int index = hashFunction(driver->getId());
-    Node *newNode = new Node(driver);
+  DriverRegistry(const DriverRegistry &) = delete;
+  DriverRegistry &operator=(const DriverRegistry &) = delete;
+
+  // Takes ownership on success. Returns a null handle (and leaves ownership
+  // with the caller) if the id is already registered.
+  DriverHandle addDriver(Driver *driver) {
+    if (idToSlot.contains(driver->getId()))
+      return DriverHandle();
+
+    int s = acquireSlot();
+    slots[s].denseIndex = (int)drivers.size();
+    drivers.push_back(driver);
+    denseToSlot.push_back(s);
+    idToSlot.put(driver->getId(), s);
+    return DriverHandle(s, slots[s].generation);
+  }
+
+  // Removes and deletes the driver. Remaining drivers keep their relative
+  // registration order.
+  bool removeDriver(const std::string &id) {
+    const int *found = idToSlot.find(id);
+    if (!found)
+      return false;
+
+    int s = *found;
+    int index = slots[s].denseIndex;
+    delete drivers[index];
 
-    if (table[index] == nullptr) {
-      table[index] = newNode;
-    } else {
-      // Collision: Insert at head (Chaining)
-      newNode->next = table[index];
-      table[index] = newNode;
+    drivers.erase(drivers.begin() + index);
+    denseToSlot.erase(denseToSlot.begin() + index);
+    for (size_t i = index; i < drivers.size(); ++i) {
+      slots[denseToSlot[i]].denseIndex = (int)i;
     }
+
+    idToSlot.remove(id);
+    releaseSlot(s);
+    return true;
+  }
+
+  // Seat change: `replacement` takes over the outgoing driver's position in
+  // iteration order. The outgoing driver is deleted and its handles go stale.
+  // Returns a null handle (ownership stays with the caller) on failure.
+  DriverHandle replaceDriver(const std::string &outgoingId,
+                             Driver *replacement) {
+    const int *found = idToSlot.find(outgoingId);
+    if (!found)
+      return DriverHandle();
+    if (replacement->getId() != outgoingId &&
+        idToSlot.contains(replacement->getId()))
+      return DriverHandle();
+
+    int oldSlot = *found;
+    int index = slots[oldSlot].denseIndex;
+    delete drivers[index];
+
+    idToSlot.remove(outgoingId);
+    releaseSlot(oldSlot);
+
+    int s = acquireSlot();
+    slots[s].denseIndex = index;
+    drivers[index] = replacement;
+    denseToSlot[index] = s;
+    idToSlot.put(replacement->getId(), s);
+    return DriverHandle(s, slots[s].generation);
   }
 
   Driver *getDriver(const std::string &id) {
-    int index = hashFunction(id);
-    Node *current = table[index];
-
-    while (current != nullptr) {
-      if (current->driver->getId() == id) {
-        return current->driver;
-      }
-      current = current->next;
-    }
-    return nullptr;
+    const int *s = idToSlot.find(id);
+    return s ? drivers[slots[*s].denseIndex] : nullptr;
+  }
+
+  Driver *getDriver(const DriverHandle &handle) {
+    if (!isValid(handle))
+      return nullptr;
+    return drivers[slots[handle.slot].denseIndex];
   }
 
-  // Helper to iterate (for debugging/display)
+  DriverHandle getHandle(const std::string &id) {
+    const int *s = idToSlot.find(id);
+    return s ? DriverHandle(*s, slots[*s].generation) : DriverHandle();
+  }
+
+  // Position in registration order, -1 if not registered
+  int indexOf(const std::string &id) const {
+    const int *s = idToSlot.find(id);
+    return s ? slots[*s].denseIndex : -1;
+  }
+
+  bool isValid(const DriverHandle &handle) const {
+    return handle.slot >= 0 && handle.slot < (int)slots.size() &&
+           slots[handle.slot].generation == handle.generation &&
+           slots[handle.slot].denseIndex >= 0;
+  }
+
+  int size() const { return (int)drivers.size(); }
+
+  // Registration order
+  const std::vector<Driver *> &getDrivers() const { return drivers; }
+
+  // Iterates in registration order
   template <typename Func> void forEach(Func func) {
-    for (int i = 0; i < TABLE_SIZE; ++i) {
-      Node *current = table[i];
-      while (current != nullptr) {
-        func(current->driver);
-        current = current->next;
-      }
+    for (size_t i = 0; i < drivers.size(); ++i) {
+      func(drivers[i]);
     }
   }
 };
@@ -0,0 +1,106 @@
+#ifndef EVENT_PARSER_H
+#define EVENT_PARSER_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Event {
+  std::string type;   // LAP, PIT, POS, OVERTAKE
+  float value;        // Time or Position
+  std::string detail; // Extra info (e.g., Tyre Compound Name)
+};
+
+// Race metadata carried on the tape alongside events
+enum class MetaKind {
+  BatchTrackName, // BATCH,race,lap,TRACK:NAME:<name>  (stored at [raceId])
+  TrackName,      // race,lap,TRACK,NAME,<name>        (stored at [raceId - 1])
+  Weather         // race,lap,<any>,WEATHER,<value>
+};
+
+// Stateless line parser shared by the serial, lazy and parallel loaders.
+// A trailing '\r' (CRLF tape) is ignored here, so the loaders agree.
+// onEvent(raceId, lap, driverId, const Event &)
+// onMeta(MetaKind, raceId, const std::string &text, float value)
+namespace EventParser {
+
+template <typename OnEvent, typename OnMeta>
+void parseLine(const std::string &line, OnEvent onEvent, OnMeta onMeta) {
+  if (!line.empty() && line.back() == '\r') {
+    parseLine(line.substr(0, line.size() - 1), onEvent, onMeta);
+    return;
+  }
+  std::stringstream ss(line);
+
+  // BATCH MODE
+  if (line.rfind("BATCH,", 0) == 0) {
+    std::string segment;
+    std::vector<std::string> parts;
+    while (std::getline(ss, segment, ',')) {
+      parts.push_back(segment);
+    }
+
+    if (parts.size() < 4)
+      return;
+
+    try {
+      int raceId = std::stoi(parts[1]);
+      int lap = std::stoi(parts[2]);
+
+      // Check for TRACK,NAME event in batch mode
+      // Format: BATCH,raceId,lap,TRACK:NAME:TrackName
+      if (parts.size() >= 4 && parts[3].rfind("TRACK:NAME:", 0) == 0) {
+        onMeta(MetaKind::BatchTrackName, raceId,
+               parts[3].substr(11), // "TRACK:NAME:".length()
+               0.0f);
+        return; // Processed this line, move to next
+      }
+
+      for (size_t i = 3; i < parts.size(); ++i) {
+        std::string item = parts[i];
+        size_t colonPos = item.find(':');
+        if (colonPos != std::string::npos) {
+          std::string driverId = item.substr(0, colonPos);
+          float time = std::stof(item.substr(colonPos + 1));
+          onEvent(raceId, lap, driverId, Event{"LAP", time, ""});
+        }
+      }
+    } catch (...) {
+    }
+
+  } else {
+    // STANDARD MODE
+    std::string raceIdStr, lapStr, driverId, type, valStr;
+    if (std::getline(ss, raceIdStr, ',') && std::getline(ss, lapStr, ',') &&
+        std::getline(ss, driverId, ',') && std::getline(ss, type, ',') &&
+        std::getline(ss, valStr, ',')) {
+
+      try {
+        int raceId = std::stoi(raceIdStr);
+        int lap = std::stoi(lapStr);
+
+        float val = 0.0f;
+        std::string detail = "";
+
+        if (type == "COMPOUND" || (driverId == "TRACK" && type == "NAME")) {
+          detail = valStr; // Treat as string
+        } else {
+          val = std::stof(valStr);
+        }
+
+        if (driverId == "TRACK" && type == "NAME") {
+          onMeta(MetaKind::TrackName, raceId, detail, 0.0f);
+        } else if (type == "WEATHER") {
+          onMeta(MetaKind::Weather, raceId, "", val);
+        } else {
+          onEvent(raceId, lap, driverId, Event{type, val, detail});
+        }
+      } catch (...) {
+      }
+    }
+  }
+}
+
+} // namespace EventParser
+
+#endif // EVENT_PARSER_H
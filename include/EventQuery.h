@@ -0,0 +1,305 @@
+#ifndef EVENT_QUERY_H
+#define EVENT_QUERY_H
+
+#include "EventParser.h"
+#include "HashMap.h"
+#include "LapTelemetry.h"
+#include "MemoryAccounting.h"
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Predicate filters; unset fields match everything. Value bounds are
+// inclusive and apply to Event::value (lap time for LAP, position for POS).
+struct EventQuery {
+  int raceId = -1;
+  int lapMin = 0;
+  int lapMax = INT_MAX;
+  std::string driver;
+  std::string type;
+  std::string compound; // Tyre fitted when the event happened
+  int wet = -1;         // 0 = dry races, 1 = wet races
+  float valueMin = -std::numeric_limits<float>::infinity();
+  float valueMax = std::numeric_limits<float>::infinity();
+
+  // Space separated terms:
+  //   race=2  lap=40  lap=40-  lap=10-20  driver=VER  type=PIT
+  //   compound=Hard  weather=wet|dry  value>120  value<=90  value=1
+  static bool parse(const std::string &text, EventQuery &out,
+                    std::string &error) {
+    out = EventQuery();
+    std::stringstream ss(text);
+    std::string term;
+    while (ss >> term) {
+      size_t op = term.find_first_of("=<>");
+      if (op == std::string::npos || op == 0 || op + 1 >= term.size()) {
+        error = "Malformed term: " + term;
+        return false;
+      }
+      std::string key = term.substr(0, op);
+      char cmp = term[op];
+      bool inclusive = cmp == '=';
+      if (cmp != '=' && term[op + 1] == '=') {
+        inclusive = true;
+        op++;
+      }
+      std::string value = term.substr(op + 1);
+      try {
+        if (key == "value") {
+          float v = std::stof(value);
+          if (cmp != '<')
+            out.valueMin = inclusive ? v : std::nextafter(v, out.valueMax);
+          if (cmp != '>')
+            out.valueMax = inclusive ? v : std::nextafter(v, out.valueMin);
+          continue;
+        }
+        if (cmp != '=') {
+          error = "Only value supports < and >: " + term;
+          return false;
+        }
+        if (key == "race") {
+          out.raceId = std::stoi(value);
+        } else if (key == "lap") {
+          size_t dash = value.find('-');
+          if (dash == std::string::npos) {
+            out.lapMin = out.lapMax = std::stoi(value);
+          } else {
+            out.lapMin = dash > 0 ? std::stoi(value.substr(0, dash)) : 0;
+            out.lapMax = dash + 1 < value.size()
+                             ? std::stoi(value.substr(dash + 1))
+                             : INT_MAX;
+          }
+        } else if (key == "driver") {
+          out.driver = value;
+        } else if (key == "type") {
+          out.type = value;
+          for (char &c : out.type)
+            c = (char)std::toupper((unsigned char)c);
+        } else if (key == "compound") {
+          out.compound = value;
+        } else if (key == "weather") {
+          if (value == "wet" || value == "rainy") {
+            out.wet = 1;
+          } else if (value == "dry") {
+            out.wet = 0;
+          } else {
+            error = "Weather must be wet or dry: " + value;
+            return false;
+          }
+        } else {
+          error = "Unknown field: " + key;
+          return false;
+        }
+      } catch (...) {
+        error = "Bad number in: " + term;
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+// One stored event, flattened
+struct EventRow {
+  int raceId;
+  int lap;
+  int driverSlot;
+  int typeCode;
+  uint8_t compound; // LapTelemetryCodec::compoundCode, 0 = unknown
+  float value;
+};
+
+// Column indexes over every loaded event, built in one pass over the
+// RaceID -> Lap -> DriverID store. Each column value (race, lap, driver,
+// type, compound, weather) maps to a RoaringBitmap of row ids; a query
+// intersects the bitmaps of its predicates. Event values are kept sorted
+// so value ranges are two binary searches.
+class EventQueryIndex {
+private:
+  std::vector<EventRow> rows;
+
+  std::vector<std::string> driverIds;
+  HashMap<std::string, int> driverSlot;
+  std::vector<std::string> typeNames;
+  HashMap<std::string, int> typeCode;
+
+  std::vector<RoaringBitmap> byRace;
+  std::vector<RoaringBitmap> byLap;
+  std::vector<RoaringBitmap> byDriver;
+  std::vector<RoaringBitmap> byType;
+  std::vector<RoaringBitmap> byCompound;
+  RoaringBitmap byWeather[2]; // Dry, wet
+
+  std::vector<uint32_t> valueOrder; // Row ids, ascending by value
+
+  template <typename Key>
+  static int codeFor(const Key &key, std::vector<Key> &names,
+                     HashMap<Key, int> &codes) {
+    const int *code = codes.find(key);
+    if (code)
+      return *code;
+    int c = (int)names.size();
+    codes.put(key, c);
+    names.push_back(key);
+    return c;
+  }
+
+  static void addTo(std::vector<RoaringBitmap> &column, size_t value,
+                    uint32_t row) {
+    if (value >= column.size())
+      column.resize(value + 1);
+    column[value].add(row);
+  }
+
+  static const RoaringBitmap &at(const std::vector<RoaringBitmap> &column,
+                                 int value) {
+    static const RoaringBitmap none;
+    return value >= 0 && value < (int)column.size() ? column[value] : none;
+  }
+
+  static RoaringBitmap fromIds(std::vector<uint32_t> ids) {
+    std::sort(ids.begin(), ids.end());
+    RoaringBitmap b;
+    for (uint32_t id : ids)
+      b.add(id);
+    return b;
+  }
+
+public:
+  EventQueryIndex() : driverSlot(64), typeCode(16) {}
+
+  // `weatherOf(raceId)` > 0.1 counts as wet (same rule as the results)
+  template <typename RaceEvents, typename WeatherOf>
+  void build(RaceEvents &raceEvents, WeatherOf weatherOf) {
+    *this = EventQueryIndex();
+    for (size_t raceId = 0; raceId < raceEvents.size(); ++raceId) {
+      bool wet = weatherOf((int)raceId) > 0.1f;
+      HashMap<std::string, uint8_t> fitted(64); // Driver -> Current compound
+      for (size_t lap = 0; lap < raceEvents[raceId].size(); ++lap) {
+        raceEvents[raceId][lap].forEach(
+            [&](const std::string &driverId, const std::vector<Event> &events) {
+              for (const Event &ev : events) {
+                if (ev.type == "COMPOUND")
+                  fitted.put(driverId,
+                             LapTelemetryCodec::compoundCode(ev.detail));
+              }
+              const uint8_t *compound = fitted.find(driverId);
+              int slot = codeFor(driverId, driverIds, driverSlot);
+              for (const Event &ev : events) {
+                uint32_t row = (uint32_t)rows.size();
+                EventRow r{(int)raceId, (int)lap, slot,
+                           codeFor(ev.type, typeNames, typeCode),
+                           compound ? *compound : (uint8_t)0, ev.value};
+                rows.push_back(r);
+                addTo(byRace, raceId, row);
+                addTo(byLap, lap, row);
+                addTo(byDriver, slot, row);
+                addTo(byType, r.typeCode, row);
+                addTo(byCompound, r.compound, row);
+                byWeather[wet ? 1 : 0].add(row);
+              }
+            });
+      }
+    }
+    valueOrder.resize(rows.size());
+    for (uint32_t i = 0; i < (uint32_t)rows.size(); ++i)
+      valueOrder[i] = i;
+    std::stable_sort(valueOrder.begin(), valueOrder.end(),
+                     [&](uint32_t a, uint32_t b) {
+                       return rows[a].value < rows[b].value;
+                     });
+  }
+
+  RoaringBitmap select(const EventQuery &q) const {
+    RoaringBitmap result;
+    bool narrowed = false; // false = every row still matches
+    auto narrow = [&](const RoaringBitmap &b) {
+      if (narrowed) {
+        result &= b;
+      } else {
+        result = b;
+        narrowed = true;
+      }
+    };
+
+    if (q.raceId >= 0)
+      narrow(at(byRace, q.raceId));
+    if (!q.driver.empty()) {
+      const int *slot = driverSlot.find(q.driver);
+      narrow(at(byDriver, slot ? *slot : -1));
+    }
+    if (!q.type.empty()) {
+      const int *code = typeCode.find(q.type);
+      narrow(at(byType, code ? *code : -1));
+    }
+    if (!q.compound.empty()) {
+      uint8_t code = LapTelemetryCodec::compoundCode(q.compound);
+      narrow(at(byCompound, code ? code : -1));
+    }
+    if (q.wet >= 0)
+      narrow(byWeather[q.wet]);
+
+    // Ranges: once another predicate has narrowed the set, checking the
+    // survivors' rows is cheaper than building the range bitmap
+    bool lapRange = q.lapMin > 0 || q.lapMax < (int)byLap.size() - 1;
+    bool valueRange = q.valueMin > -std::numeric_limits<float>::infinity() ||
+                      q.valueMax < std::numeric_limits<float>::infinity();
+    if (narrowed && (lapRange || valueRange)) {
+      RoaringBitmap kept;
+      result.forEach([&](uint32_t row) {
+        const EventRow &r = rows[row];
+        if (r.lap >= q.lapMin && r.lap <= q.lapMax && r.value >= q.valueMin &&
+            r.value <= q.valueMax)
+          kept.add(row);
+      });
+      return kept;
+    }
+    if (lapRange) {
+      std::vector<uint32_t> ids;
+      int last = std::min(q.lapMax, (int)byLap.size() - 1);
+      for (int lap = std::max(0, q.lapMin); lap <= last; ++lap)
+        byLap[lap].forEach([&](uint32_t row) { ids.push_back(row); });
+      narrow(fromIds(ids));
+    }
+    if (valueRange) {
+      auto lo = std::lower_bound(
+          valueOrder.begin(), valueOrder.end(), q.valueMin,
+          [&](uint32_t row, float v) { return rows[row].value < v; });
+      auto hi = std::upper_bound(
+          lo, valueOrder.end(), q.valueMax,
+          [&](float v, uint32_t row) { return v < rows[row].value; });
+      narrow(fromIds(std::vector<uint32_t>(lo, hi)));
+    }
+    return narrowed ? result : RoaringBitmap::range((uint32_t)rows.size());
+  }
+
+  size_t getRowCount() const { return rows.size(); }
+  const EventRow &getRow(uint32_t row) const { return rows[row]; }
+  const std::string &driverName(int slot) const { return driverIds[slot]; }
+  const std::string &typeName(int code) const { return typeNames[code]; }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(vectorHeap(rows), rows.size());
+    u.add(vectorHeap(valueOrder) + driverSlot.footprint() +
+          typeCode.footprint() + vectorHeap(driverIds) + vectorHeap(typeNames));
+    for (const auto *column : {&byRace, &byLap, &byDriver, &byType,
+                               &byCompound}) {
+      u.add(vectorHeap(*column));
+      for (const RoaringBitmap &b : *column)
+        u.add(b.memoryBytes(), 1);
+    }
+    u.add(byWeather[0].memoryBytes() + byWeather[1].memoryBytes(), 2);
+    return u;
+  }
+};
+
+#endif // EVENT_QUERY_H
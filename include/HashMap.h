@@ -151,6 +151,45 @@ public:
     return false;
   }
 
+  // Single lookup: pointer to value, or nullptr if missing
+  V *find(const K &key) {
+    HashNode<K, V> *entry = table[hashFunction(key)];
+    while (entry != nullptr) {
+      if (entry->key == key) {
+        return &entry->value;
+      }
+      entry = entry->next;
+    }
+    return nullptr;
+  }
+
+  const V *find(const K &key) const {
+    return const_cast<HashMap *>(this)->find(key);
+  }
+
+  // Remove key (returns false if missing)
+  bool remove(const K &key) {
+    int hashIndex = hashFunction(key);
+    HashNode<K, V> *prev = nullptr;
+    HashNode<K, V> *entry = table[hashIndex];
+
+    while (entry != nullptr) {
+      if (entry->key == key) {
+        if (prev == nullptr) {
+          table[hashIndex] = entry->next;
+        } else {
+          prev->next = entry->next;
+        }
+        delete entry;
+        size--;
+        return true;
+      }
+      prev = entry;
+      entry = entry->next;
+    }
+    return false;
+  }
+
   // Get Size
   int getSize() const { return size; }
 
@@ -177,6 +216,23 @@ public:
       }
     }
   }
+
+  template <typename Func> void forEach(Func func) const {
+    for (int i = 0; i < capacity; ++i) {
+      const HashNode<K, V> *entry = table[i];
+      while (entry != nullptr) {
+        func(entry->key, entry->value);
+        entry = entry->next;
+      }
+    }
+  }
+
+  // Bytes held by the bucket table and the nodes themselves (memory owned
+  // by keys and values is not included)
+  size_t footprint() const {
+    return table.capacity() * sizeof(HashNode<K, V> *) +
+           (size_t)size * sizeof(HashNode<K, V>);
+  }
 };
 
 #endif // HASHMAP_H
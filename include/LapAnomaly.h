@@ -0,0 +1,223 @@
+#ifndef LAP_ANOMALY_H
+#define LAP_ANOMALY_H
+
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Running median over a stream: a max-heap holds the lower half and a
+// min-heap the upper half (sizes differ by at most one). add() is
+// O(log n), median() is O(1).
+class StreamingMedian {
+private:
+  std::priority_queue<float> lower;
+  std::priority_queue<float, std::vector<float>, std::greater<float>> upper;
+
+public:
+  void add(float x) {
+    if (lower.empty() || x <= lower.top())
+      lower.push(x);
+    else
+      upper.push(x);
+    if (lower.size() > upper.size() + 1) {
+      upper.push(lower.top());
+      lower.pop();
+    } else if (upper.size() > lower.size()) {
+      lower.push(upper.top());
+      upper.pop();
+    }
+  }
+
+  size_t size() const { return lower.size() + upper.size(); }
+  bool empty() const { return lower.empty(); }
+
+  float median() const {
+    if (lower.empty())
+      return 0.0f;
+    if (lower.size() > upper.size())
+      return lower.top();
+    return (lower.top() + upper.top()) * 0.5f;
+  }
+
+  void clear() {
+    lower = std::priority_queue<float>();
+    upper = std::priority_queue<float, std::vector<float>, std::greater<float>>();
+  }
+};
+
+struct AnomalyLimits {
+  float slowFactor = 1.10f;  // Lap median above reference x this: neutralized
+  float startFactor = 1.25f; // Same for the opening (standing start) lap
+  float priorPace = 1.07f;   // Green pace assumed as ideal lap x this...
+  int warmupLaps = 3;        // ...until this many green laps were seen
+  float outlierZ = 3.5f;     // Modified z-score of a slow driver lap
+  float minMad = 0.05f;      // Floor for the spread (identical times)
+};
+
+// Field summary of one lap
+struct LapAnomaly {
+  int lap = -1;
+  int drivers = 0;        // Lap times recorded
+  float median = 0.0f;    // Field median lap time
+  float mad = 0.0f;       // Median absolute deviation from it
+  float reference = 0.0f; // Green-flag pace it was compared with
+  bool opening = false;   // First lap with times (standing start)
+  bool neutralized = false;
+  std::vector<std::pair<std::string, float>> outliers; // Driver, lap time
+};
+
+// Online safety car / VSC / red flag detection for one race. Every lap
+// time goes into a two-heap median of its lap (O(log N) per event); when
+// the lap is finalized the MAD is taken once (O(N) per lap) and:
+//  - the lap is neutralized if the field median is slowFactor above the
+//    green-flag reference: the running median of earlier green laps'
+//    medians, or the track's ideal lap x priorPace during warm-up. The
+//    opening lap (standing start) is allowed startFactor instead and is
+//    kept out of the reference;
+//  - otherwise a driver whose modified z-score 0.6745 (t - median) / MAD
+//    exceeds outlierZ is a slow outlier (pit laps, incidents).
+// Only slow laps are flagged, so personal bests are never excluded.
+class LapAnomalyDetector {
+private:
+  AnomalyLimits limits;
+  float prior; // 0 = no ideal lap time known
+
+  std::vector<LapAnomaly> laps; // By lap number
+  StreamingMedian green;        // Medians of non-neutralized laps
+  bool seenTimedLap;            // A stored lap has times (opening lap done)
+
+  int openLap;
+  StreamingMedian openMedian;
+  std::vector<std::pair<std::string, float>> openTimes;
+
+  float reference() const {
+    if ((int)green.size() >= limits.warmupLaps || prior <= 0.0f)
+      return green.median(); // 0 while nothing is known
+    return prior * limits.priorPace;
+  }
+
+  void rebuildGreen() {
+    green.clear();
+    seenTimedLap = false;
+    for (const LapAnomaly &a : laps) {
+      if (a.drivers > 0 && !a.neutralized && !a.opening)
+        green.add(a.median);
+      seenTimedLap = seenTimedLap || a.drivers > 0;
+    }
+  }
+
+public:
+  explicit LapAnomalyDetector(const AnomalyLimits &l = AnomalyLimits(),
+                              float idealLapTime = 0.0f)
+      : limits(l), prior(idealLapTime), seenTimedLap(false), openLap(-1) {}
+
+  void record(int lap, const std::string &driverId, float time) {
+    if (time <= 0.0f)
+      return;
+    openLap = lap;
+    openMedian.add(time);
+    openTimes.push_back({driverId, time});
+  }
+
+  // Closes `lap` (a lap without times is stored as empty). Replaces an
+  // earlier result for the same lap only if it was the last one.
+  const LapAnomaly &finalizeLap(int lap) {
+    if (lap < (int)laps.size())
+      truncateAfter(lap - 1);
+    while ((int)laps.size() < lap) {
+      LapAnomaly empty;
+      empty.lap = (int)laps.size();
+      laps.push_back(empty);
+    }
+
+    LapAnomaly a;
+    a.lap = lap;
+    if (openLap == lap && !openTimes.empty()) {
+      a.drivers = (int)openTimes.size();
+      a.median = openMedian.median();
+      std::vector<float> dev;
+      dev.reserve(openTimes.size());
+      for (const auto &t : openTimes)
+        dev.push_back(std::fabs(t.second - a.median));
+      size_t mid = dev.size() / 2;
+      std::nth_element(dev.begin(), dev.begin() + mid, dev.end());
+      float upperMid = dev[mid];
+      if (dev.size() % 2 == 0) {
+        float lowerMid =
+            *std::max_element(dev.begin(), dev.begin() + mid);
+        a.mad = (lowerMid + upperMid) * 0.5f;
+      } else {
+        a.mad = upperMid;
+      }
+      a.reference = reference();
+      a.opening = !seenTimedLap;
+      seenTimedLap = true;
+      float factor = a.opening ? limits.startFactor : limits.slowFactor;
+      a.neutralized = a.reference > 0.0f && a.median > a.reference * factor;
+      if (!a.neutralized) {
+        float scale = std::max(a.mad, limits.minMad);
+        for (const auto &t : openTimes) {
+          if (0.6745f * (t.second - a.median) / scale > limits.outlierZ)
+            a.outliers.push_back(t);
+        }
+        if (!a.opening)
+          green.add(a.median);
+      }
+    }
+    laps.push_back(std::move(a));
+
+    openLap = -1;
+    openMedian.clear();
+    openTimes.clear();
+    return laps.back();
+  }
+
+  // Forgets every lap after `lap` (live rewind)
+  void truncateAfter(int lap) {
+    if (lap + 1 >= (int)laps.size())
+      return;
+    laps.resize(lap < 0 ? 0 : lap + 1);
+    rebuildGreen();
+  }
+
+  const LapAnomaly *getLap(int lap) const {
+    return lap >= 0 && lap < (int)laps.size() ? &laps[lap] : nullptr;
+  }
+
+  bool isNeutralized(int lap) const {
+    const LapAnomaly *a = getLap(lap);
+    return a && a->neutralized;
+  }
+
+  bool isOutlier(int lap, const std::string &driverId) const {
+    const LapAnomaly *a = getLap(lap);
+    if (!a)
+      return false;
+    for (const auto &o : a->outliers) {
+      if (o.first == driverId)
+        return true;
+    }
+    return false;
+  }
+
+  const std::vector<LapAnomaly> &getLaps() const { return laps; }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(vectorHeap(laps) + green.size() * sizeof(float), laps.size());
+    for (const LapAnomaly &a : laps) {
+      u.add(vectorHeap(a.outliers));
+      for (const auto &o : a.outliers)
+        u.add(stringHeap(o.first));
+    }
+    return u;
+  }
+};
+
+#endif // LAP_ANOMALY_H
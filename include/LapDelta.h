@@ -0,0 +1,162 @@
+#ifndef LAP_DELTA_H
+#define LAP_DELTA_H
+
+#include "HashMap.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Per-lap change records. Instead of a full leaderboard snapshot after every
+// lap, consumers receive only what changed.
+enum class DeltaType : uint8_t {
+  Position = 0,   // driverId moved from -> to (from 0 = entered the order)
+  Overtake = 1,   // driverId passed otherId (inferred from the ordering)
+  FastestLap = 2, // New field fastest lap: value = lap time
+  PitIn = 3,      // value = pit time
+  PitOut = 4,     // First lap after a stop
+  Dnf = 5         // Driver confirmed out (missed laps limit reached)
+};
+
+inline const char *deltaTypeName(DeltaType t) {
+  switch (t) {
+  case DeltaType::Position:
+    return "POS";
+  case DeltaType::Overtake:
+    return "OVERTAKE";
+  case DeltaType::FastestLap:
+    return "FASTEST_LAP";
+  case DeltaType::PitIn:
+    return "PIT_IN";
+  case DeltaType::PitOut:
+    return "PIT_OUT";
+  case DeltaType::Dnf:
+    return "DNF";
+  }
+  return "UNKNOWN";
+}
+
+struct LapDelta {
+  int raceId;
+  int lap;
+  DeltaType type;
+  std::string driverId;
+  std::string otherId; // Overtake: the driver that was passed
+  int from;            // Position: previous position (0 = none)
+  int to;              // Position: new position
+  float value;         // FastestLap / PitIn: seconds
+};
+
+// Diffs the classification order of consecutive laps. Orders are kept per
+// lap, so a lap that is recomputed (late events) diffs against the correct
+// previous lap.
+class DeltaTracker {
+private:
+  std::vector<std::vector<std::string>> orders; // Lap -> DriverIDs, P1 first
+
+public:
+  void reset() { orders.clear(); }
+
+  // Emits Position and Overtake deltas for `lap` given its order
+  template <typename Emit>
+  void diffLap(int raceId, int lap, const std::vector<std::string> &order,
+               Emit emit) {
+    if (lap < 0)
+      return;
+    if (lap >= (int)orders.size())
+      orders.resize(lap + 1);
+    orders[lap] = order;
+
+    static const std::vector<std::string> none;
+    const std::vector<std::string> &prev = lap > 0 ? orders[lap - 1] : none;
+
+    HashMap<std::string, int> prevPos(64);
+    HashMap<std::string, int> curPos(64);
+    for (size_t i = 0; i < prev.size(); ++i)
+      prevPos.put(prev[i], (int)i + 1);
+    for (size_t i = 0; i < order.size(); ++i)
+      curPos.put(order[i], (int)i + 1);
+
+    for (size_t i = 0; i < order.size(); ++i) {
+      const int *before = prevPos.find(order[i]);
+      int from = before ? *before : 0;
+      int to = (int)i + 1;
+      if (from == to)
+        continue;
+      emit(LapDelta{raceId, lap, DeltaType::Position, order[i], "", from, to,
+                    0.0f});
+
+      // Everyone who was ahead last lap and is behind now was passed
+      if (from > to) {
+        for (int p = 0; p < from - 1; ++p) {
+          const int *now = curPos.find(prev[p]);
+          if (now && *now > to) {
+            emit(LapDelta{raceId, lap, DeltaType::Overtake, order[i], prev[p],
+                          from, to, 0.0f});
+          }
+        }
+      }
+    }
+  }
+};
+
+// One JSON object per line
+class NdjsonDeltaSink {
+private:
+  std::ofstream file;
+
+public:
+  explicit NdjsonDeltaSink(const std::string &filename) : file(filename) {}
+  bool isOpen() const { return file.is_open(); }
+
+  void write(const LapDelta &d) {
+    file << "{\"race\":" << d.raceId << ",\"lap\":" << d.lap << ",\"type\":\""
+         << deltaTypeName(d.type) << "\",\"driver\":\"" << d.driverId << "\"";
+    if (d.type == DeltaType::Position || d.type == DeltaType::Overtake)
+      file << ",\"from\":" << d.from << ",\"to\":" << d.to;
+    if (d.type == DeltaType::Overtake)
+      file << ",\"passed\":\"" << d.otherId << "\"";
+    if (d.type == DeltaType::FastestLap || d.type == DeltaType::PitIn)
+      file << ",\"value\":" << d.value;
+    file << "}\n";
+  }
+
+  void flush() { file.flush(); }
+};
+
+// Fixed little record per delta:
+//   u8 type | u16 race | u16 lap | u8 from | u8 to | f32 value
+//   u8 len + driverId | u8 len + otherId
+class BinaryDeltaSink {
+private:
+  std::ofstream file;
+
+  template <typename T> void put(T v) {
+    file.write(reinterpret_cast<const char *>(&v), sizeof(T));
+  }
+  void putString(const std::string &s) {
+    uint8_t len = (uint8_t)(s.size() > 255 ? 255 : s.size());
+    put<uint8_t>(len);
+    file.write(s.data(), len);
+  }
+
+public:
+  explicit BinaryDeltaSink(const std::string &filename)
+      : file(filename, std::ios::binary | std::ios::trunc) {}
+  bool isOpen() const { return file.is_open(); }
+
+  void write(const LapDelta &d) {
+    put<uint8_t>((uint8_t)d.type);
+    put<uint16_t>((uint16_t)d.raceId);
+    put<uint16_t>((uint16_t)d.lap);
+    put<uint8_t>((uint8_t)d.from);
+    put<uint8_t>((uint8_t)d.to);
+    put<float>(d.value);
+    putString(d.driverId);
+    putString(d.otherId);
+  }
+
+  void flush() { file.flush(); }
+};
+
+#endif // LAP_DELTA_H
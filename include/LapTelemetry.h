@@ -0,0 +1,199 @@
+#ifndef LAP_TELEMETRY_H
+#define LAP_TELEMETRY_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One driver, one lap, as the engine saw it at the end of that lap
+struct LapSample {
+  int lap;
+  float lapTime; // 0 = no timed lap (missed-lap penalties are included)
+  float elapsed;
+  int position;  // Filled at export from the gap index (0 = unclassified)
+  uint8_t compound;
+  uint8_t degradation; // Percent
+};
+
+// Per-race lap-by-lap samples, one append-only series per driver
+class LapTelemetry {
+private:
+  std::vector<std::string> driverIds;
+  HashMap<std::string, int> driverSlot;
+  std::vector<std::vector<LapSample>> series;
+
+public:
+  LapTelemetry() : driverSlot(64) {}
+
+  void record(const std::string &driverId, const LapSample &sample) {
+    const int *slot = driverSlot.find(driverId);
+    int s;
+    if (slot) {
+      s = *slot;
+    } else {
+      s = (int)driverIds.size();
+      driverSlot.put(driverId, s);
+      driverIds.push_back(driverId);
+      series.emplace_back();
+    }
+    std::vector<LapSample> &row = series[s];
+    if (!row.empty() && row.back().lap == sample.lap) {
+      row.back() = sample; // Same lap recomputed
+    } else {
+      row.push_back(sample);
+    }
+  }
+
+  // Drops every lap after `lap` (used when laps are recomputed)
+  void truncateAfter(int lap) {
+    for (auto &row : series) {
+      while (!row.empty() && row.back().lap > lap)
+        row.pop_back();
+    }
+  }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(driverSlot.footprint() + vectorHeap(driverIds) + vectorHeap(series));
+    for (size_t i = 0; i < driverIds.size(); ++i)
+      u.add(stringHeap(driverIds[i]) * 2 + vectorHeap(series[i]),
+            series[i].size());
+    return u;
+  }
+
+  // nullptr if the driver has no samples in this race
+  const std::vector<LapSample> *seriesFor(const std::string &driverId) const {
+    const int *slot = driverSlot.find(driverId);
+    return slot ? &series[*slot] : nullptr;
+  }
+
+  template <typename Func> void forEachDriver(Func func) {
+    for (size_t i = 0; i < driverIds.size(); ++i) {
+      func(driverIds[i], series[i]);
+    }
+  }
+};
+
+// Compact columnar encoding of lap telemetry for the dashboard.
+//
+// All integers are LEB128 varints; signed values are zigzag encoded.
+// Times are fixed-point milliseconds. Every column is delta-encoded against
+// the previous lap of the same driver, so steady values cost one byte.
+//
+//   "RLLT" u8 version
+//   varint raceCount
+//   per race:   varint raceId, varint driverCount
+//   per driver: u8 idLength, id bytes, varint sampleCount
+//               columns (sampleCount values each, in this order):
+//               lap, lapTime ms, elapsed ms, position, compound, degradation
+namespace LapTelemetryCodec {
+
+const char MAGIC[4] = {'R', 'L', 'L', 'T'};
+const uint8_t VERSION = 1;
+
+// Compound codes shared with the dashboard decoder
+inline uint8_t compoundCode(const std::string &compound) {
+  if (compound.empty())
+    return 0;
+  switch (compound[0]) {
+  case 'S':
+    return 1;
+  case 'M':
+    return 2;
+  case 'H':
+    return 3;
+  case 'I':
+    return 4;
+  case 'W':
+    return 5;
+  }
+  return 0;
+}
+
+inline int64_t toMillis(float seconds) {
+  return (int64_t)std::llround((double)seconds * 1000.0);
+}
+
+inline void putVarint(std::string &out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back((char)((v & 0x7F) | 0x80));
+    v >>= 7;
+  }
+  out.push_back((char)v);
+}
+
+inline void putSigned(std::string &out, int64_t v) {
+  putVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); // Zigzag
+}
+
+template <typename Get>
+void putColumn(std::string &out, const std::vector<LapSample> &row, Get get) {
+  int64_t previous = 0;
+  for (const LapSample &s : row) {
+    int64_t v = get(s);
+    putSigned(out, v - previous);
+    previous = v;
+  }
+}
+
+inline void beginFile(std::string &out, size_t raceCount) {
+  out.append(MAGIC, 4);
+  out.push_back((char)VERSION);
+  putVarint(out, raceCount);
+}
+
+inline void beginRace(std::string &out, int raceId, size_t driverCount) {
+  putVarint(out, (uint64_t)raceId);
+  putVarint(out, driverCount);
+}
+
+inline void putDriver(std::string &out, const std::string &driverId,
+                      const std::vector<LapSample> &row) {
+  size_t len = driverId.size() > 255 ? 255 : driverId.size();
+  out.push_back((char)len);
+  out.append(driverId, 0, len);
+  putVarint(out, row.size());
+  putColumn(out, row, [](const LapSample &s) { return (int64_t)s.lap; });
+  putColumn(out, row,
+            [](const LapSample &s) { return toMillis(s.lapTime); });
+  putColumn(out, row,
+            [](const LapSample &s) { return toMillis(s.elapsed); });
+  putColumn(out, row, [](const LapSample &s) { return (int64_t)s.position; });
+  putColumn(out, row, [](const LapSample &s) { return (int64_t)s.compound; });
+  putColumn(out, row,
+            [](const LapSample &s) { return (int64_t)s.degradation; });
+}
+
+inline std::string base64(const std::string &bytes) {
+  static const char table[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((bytes.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < bytes.size(); i += 3) {
+    uint32_t n = ((uint8_t)bytes[i] << 16) | ((uint8_t)bytes[i + 1] << 8) |
+                 (uint8_t)bytes[i + 2];
+    out.push_back(table[(n >> 18) & 63]);
+    out.push_back(table[(n >> 12) & 63]);
+    out.push_back(table[(n >> 6) & 63]);
+    out.push_back(table[n & 63]);
+  }
+  if (i < bytes.size()) {
+    uint32_t n = (uint8_t)bytes[i] << 16;
+    if (i + 1 < bytes.size())
+      n |= (uint8_t)bytes[i + 1] << 8;
+    out.push_back(table[(n >> 18) & 63]);
+    out.push_back(table[(n >> 12) & 63]);
+    out.push_back(i + 1 < bytes.size() ? table[(n >> 6) & 63] : '=');
+    out.push_back('=');
+  }
+  return out;
+}
+
+} // namespace LapTelemetryCodec
+
+#endif // LAP_TELEMETRY_H
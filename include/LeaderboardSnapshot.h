@@ -0,0 +1,165 @@
+#ifndef LEADERBOARD_SNAPSHOT_H
+#define LEADERBOARD_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// One classified driver as published after a lap
+struct LeaderboardRow {
+  int position; // 1 = leader
+  std::string id;
+  std::string name;
+  std::string team;
+  float score;
+  float raceTime; // Elapsed race time (s)
+  float gap;      // raceTime - leader's raceTime
+  int pitStops;
+  std::string compound;
+};
+
+// Immutable classification of one lap. Never modified once published.
+struct LeaderboardSnapshot {
+  uint64_t version = 0; // 1, 2, ... in publish order
+  int raceId = -1;
+  int lap = -1;       // -1 on the final classification
+  bool final = false; // Published by endRace
+  std::vector<LeaderboardRow> rows;
+};
+
+// Single-writer, many-reader publication of leaderboard snapshots, RCU
+// style: the writer builds a new snapshot off to the side and swaps one
+// atomic pointer; readers pin the snapshot they loaded through a reader
+// slot tagged with the global epoch. A replaced snapshot is freed once no
+// slot holds an epoch at or before the swap. Neither side takes a lock:
+// publish() is an exchange plus a scan of the slots, and a read is one CAS
+// to claim a slot plus a pointer load.
+//
+//   LeaderboardPublisher::Reader r = season.readLeaderboard();
+//   if (r)
+//     for (const LeaderboardRow &row : r->rows) ...
+//
+// Up to READER_SLOTS reads may be in flight at once (further readers yield
+// until a slot frees up); any number of threads may read.
+class LeaderboardPublisher {
+public:
+  static const int READER_SLOTS = 64;
+
+private:
+  // Own cache line each, so readers do not contend on the claim
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{0}; // 0 = free
+  };
+
+  std::atomic<const LeaderboardSnapshot *> current;
+  std::atomic<uint64_t> epoch;
+  mutable ReaderSlot slots[READER_SLOTS];
+
+  // Writer only: replaced snapshots and the epoch they were retired in
+  std::vector<std::pair<uint64_t, const LeaderboardSnapshot *>> retired;
+  uint64_t published;
+
+  void reclaim() {
+    uint64_t oldestReader = UINT64_MAX;
+    for (const ReaderSlot &s : slots) {
+      uint64_t e = s.epoch.load();
+      if (e != 0 && e < oldestReader)
+        oldestReader = e;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i) {
+      if (retired[i].first < oldestReader) {
+        delete retired[i].second;
+      } else {
+        retired[kept++] = retired[i];
+      }
+    }
+    retired.resize(kept);
+  }
+
+public:
+  // Pins one snapshot until destroyed (move-only)
+  class Reader {
+  private:
+    friend class LeaderboardPublisher;
+    ReaderSlot *slot;
+    const LeaderboardSnapshot *snapshot;
+
+    Reader(ReaderSlot *s, const LeaderboardSnapshot *snap)
+        : slot(s), snapshot(snap) {}
+
+  public:
+    Reader(Reader &&other) : slot(other.slot), snapshot(other.snapshot) {
+      other.slot = nullptr;
+      other.snapshot = nullptr;
+    }
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+    Reader &operator=(Reader &&) = delete;
+    ~Reader() {
+      if (slot)
+        slot->epoch.store(0, std::memory_order_release);
+    }
+
+    // nullptr before the first publish
+    const LeaderboardSnapshot *get() const { return snapshot; }
+    const LeaderboardSnapshot *operator->() const { return snapshot; }
+    const LeaderboardSnapshot &operator*() const { return *snapshot; }
+    explicit operator bool() const { return snapshot != nullptr; }
+  };
+
+  LeaderboardPublisher() : current(nullptr), epoch(1), published(0) {}
+
+  // Readers must be finished before the publisher goes away
+  ~LeaderboardPublisher() {
+    delete current.load();
+    for (const auto &r : retired)
+      delete r.second;
+  }
+
+  LeaderboardPublisher(const LeaderboardPublisher &) = delete;
+  LeaderboardPublisher &operator=(const LeaderboardPublisher &) = delete;
+
+  // Writer thread only. Stamps the version and makes `snapshot` current.
+  void publish(LeaderboardSnapshot snapshot) {
+    LeaderboardSnapshot *next = new LeaderboardSnapshot(std::move(snapshot));
+    next->version = ++published;
+    const LeaderboardSnapshot *old = current.exchange(next);
+    // A reader that can still see `old` announced an epoch <= this one
+    uint64_t retiredAt = epoch.fetch_add(1);
+    if (old)
+      retired.push_back({retiredAt, old});
+    reclaim();
+  }
+
+  // Any thread. The slot search starts at a per-thread offset.
+  Reader read() const {
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (;;) {
+      for (int i = 0; i < READER_SLOTS; ++i) {
+        ReaderSlot &s = slots[(start + i) % READER_SLOTS];
+        uint64_t free = 0;
+        if (s.epoch.load(std::memory_order_relaxed) == 0 &&
+            s.epoch.compare_exchange_strong(free, epoch.load()))
+          return Reader(&s, current.load());
+      }
+      std::this_thread::yield(); // Every slot busy
+    }
+  }
+
+  // Copy of the current snapshot (empty, version 0, before the first one)
+  LeaderboardSnapshot copy() const {
+    Reader r = read();
+    return r ? *r : LeaderboardSnapshot();
+  }
+
+  // Writer thread only
+  uint64_t getPublishedCount() const { return published; }
+  size_t getRetiredCount() const { return retired.size(); }
+};
+
+#endif // LEADERBOARD_SNAPSHOT_H
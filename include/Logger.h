@@ -0,0 +1,381 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LogLevel { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+inline const char *logLevelName(LogLevel level) {
+  switch (level) {
+  case LogLevel::Debug:
+    return "debug";
+  case LogLevel::Info:
+    return "info";
+  case LogLevel::Warn:
+    return "warn";
+  case LogLevel::Error:
+    return "error";
+  case LogLevel::Off:
+    break;
+  }
+  return "off";
+}
+
+inline bool parseLogLevel(const std::string &name, LogLevel &out) {
+  for (int l = 0; l <= (int)LogLevel::Off; ++l) {
+    if (name == logLevelName((LogLevel)l)) {
+      out = (LogLevel)l;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct LogRecord {
+  LogLevel level;
+  double millis; // Since logger start
+  std::string message;
+};
+
+// Output target. Called only from the logger thread; write() may buffer,
+// flush() is called whenever the queue runs empty.
+class LogSink {
+public:
+  LogLevel minLevel;
+
+  explicit LogSink(LogLevel level) : minLevel(level) {}
+  virtual ~LogSink() {}
+  virtual void write(const LogRecord &rec) = 0;
+  virtual void flush() = 0;
+};
+
+// Plain message text: info and below to stdout, warnings and errors to stderr
+class ConsoleLogSink : public LogSink {
+public:
+  explicit ConsoleLogSink(LogLevel level = LogLevel::Info) : LogSink(level) {}
+
+  void write(const LogRecord &rec) override {
+    FILE *out = rec.level >= LogLevel::Warn ? stderr : stdout;
+    std::fwrite(rec.message.data(), 1, rec.message.size(), out);
+    std::fputc('\n', out);
+  }
+  void flush() override {
+    std::fflush(stdout);
+    std::fflush(stderr);
+  }
+};
+
+// "<ms> <level> <message>" per line
+class FileLogSink : public LogSink {
+private:
+  FILE *file;
+
+public:
+  FileLogSink(const std::string &path, LogLevel level = LogLevel::Debug)
+      : LogSink(level), file(std::fopen(path.c_str(), "w")) {}
+  ~FileLogSink() override {
+    if (file)
+      std::fclose(file);
+  }
+  bool isOpen() const { return file != nullptr; }
+
+  void write(const LogRecord &rec) override {
+    if (file)
+      std::fprintf(file, "%.3f %s %s\n", rec.millis, logLevelName(rec.level),
+                   rec.message.c_str());
+  }
+  void flush() override {
+    if (file)
+      std::fflush(file);
+  }
+};
+
+// {"t":<ms>,"level":"info","msg":"..."} per line
+class NdjsonLogSink : public LogSink {
+private:
+  FILE *file;
+  std::string line;
+
+public:
+  NdjsonLogSink(const std::string &path, LogLevel level = LogLevel::Debug)
+      : LogSink(level), file(std::fopen(path.c_str(), "w")) {}
+  ~NdjsonLogSink() override {
+    if (file)
+      std::fclose(file);
+  }
+  bool isOpen() const { return file != nullptr; }
+
+  void write(const LogRecord &rec) override {
+    if (!file)
+      return;
+    line.clear();
+    for (char c : rec.message) {
+      switch (c) {
+      case '"':
+        line += "\\\"";
+        break;
+      case '\\':
+        line += "\\\\";
+        break;
+      case '\n':
+        line += "\\n";
+        break;
+      case '\r':
+        line += "\\r";
+        break;
+      case '\t':
+        line += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          char esc[8];
+          std::snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+          line += esc;
+        } else {
+          line += c;
+        }
+      }
+    }
+    std::fprintf(file, "{\"t\":%.3f,\"level\":\"%s\",\"msg\":\"%s\"}\n",
+                 rec.millis, logLevelName(rec.level), line.c_str());
+  }
+  void flush() override {
+    if (file)
+      std::fflush(file);
+  }
+};
+
+// Asynchronous logger. Producers push records into a bounded lock-free
+// ring (multi-producer, single-consumer, per-slot sequence numbers); one
+// background thread drains it into the sinks and flushes them only when the
+// ring runs empty. A full ring makes producers wait (nothing is dropped).
+class Logger {
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    LogRecord record;
+  };
+
+  static const size_t CAPACITY = 4096; // Power of two
+
+  std::unique_ptr<Slot[]> ring;
+  std::atomic<size_t> enqueuePos;
+  size_t dequeuePos; // Consumer thread only
+
+  std::atomic<size_t> processed;
+  std::atomic<bool> sleeping;
+  std::atomic<bool> stopping;
+  std::atomic<int> threshold; // Lowest level any sink accepts
+
+  std::mutex mtx; // Guards sinks and the wait below
+  std::condition_variable wake;
+  std::condition_variable drained;
+  std::vector<std::unique_ptr<LogSink>> sinks;
+
+  std::chrono::steady_clock::time_point start;
+  std::thread worker;
+
+  void updateThreshold() {
+    int lowest = (int)LogLevel::Off;
+    for (const auto &s : sinks) {
+      if ((int)s->minLevel < lowest)
+        lowest = (int)s->minLevel;
+    }
+    threshold.store(lowest);
+  }
+
+  bool tryPop(LogRecord &out) {
+    Slot &slot = ring[dequeuePos & (CAPACITY - 1)];
+    size_t seq = slot.sequence.load(std::memory_order_acquire);
+    if (seq != dequeuePos + 1)
+      return false; // Empty (or the producer is still writing)
+    out = std::move(slot.record);
+    slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+    dequeuePos++;
+    return true;
+  }
+
+  bool ringEmpty() const {
+    const Slot &slot = ring[dequeuePos & (CAPACITY - 1)];
+    return slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+  }
+
+  void run() {
+    LogRecord rec;
+    while (true) {
+      bool any = false;
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        while (tryPop(rec)) {
+          any = true;
+          for (auto &s : sinks) {
+            if (rec.level >= s->minLevel)
+              s->write(rec);
+          }
+          processed.fetch_add(1);
+        }
+        if (any) {
+          for (auto &s : sinks)
+            s->flush();
+        }
+        drained.notify_all();
+      }
+      if (any)
+        continue;
+
+      std::unique_lock<std::mutex> lock(mtx);
+      sleeping.store(true);
+      if (stopping.load() && ringEmpty()) {
+        sleeping.store(false);
+        break;
+      }
+      wake.wait_for(lock, std::chrono::milliseconds(50), [&] {
+        return stopping.load() || !ringEmpty();
+      });
+      sleeping.store(false);
+    }
+  }
+
+public:
+  Logger()
+      : ring(new Slot[CAPACITY]), enqueuePos(0), dequeuePos(0), processed(0),
+        sleeping(false), stopping(false), threshold((int)LogLevel::Info),
+        start(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < CAPACITY; ++i)
+      ring[i].sequence.store(i);
+    sinks.emplace_back(new ConsoleLogSink());
+    worker = std::thread(&Logger::run, this);
+  }
+
+  ~Logger() {
+    stopping.store(true);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      wake.notify_one();
+    }
+    worker.join();
+  }
+
+  static Logger &instance() {
+    static Logger logger;
+    return logger;
+  }
+
+  bool enabled(LogLevel level) const { return (int)level >= threshold.load(); }
+
+  void push(LogLevel level, std::string message) {
+    double millis = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = ring[pos & (CAPACITY - 1)];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      if (seq == pos) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          slot.record.level = level;
+          slot.record.millis = millis;
+          slot.record.message = std::move(message);
+          slot.sequence.store(pos + 1, std::memory_order_seq_cst);
+          break;
+        }
+      } else if (seq < pos) {
+        std::this_thread::yield(); // Ring full: wait for the writer
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    if (sleeping.load()) {
+      std::lock_guard<std::mutex> lock(mtx);
+      wake.notify_one();
+    }
+  }
+
+  // Blocks until everything logged so far has reached the sinks
+  void flush() {
+    size_t target = enqueuePos.load();
+    std::unique_lock<std::mutex> lock(mtx);
+    wake.notify_one();
+    drained.wait(lock, [&] { return processed.load() >= target; });
+  }
+
+  // Sink setup (call from the main thread before heavy logging)
+  void addSink(LogSink *sink) {
+    flush();
+    std::lock_guard<std::mutex> lock(mtx);
+    sinks.emplace_back(sink);
+    updateThreshold();
+  }
+
+  void setConsoleLevel(LogLevel level) {
+    flush();
+    std::lock_guard<std::mutex> lock(mtx);
+    sinks[0]->minLevel = level; // Console is always the first sink
+    updateThreshold();
+  }
+
+  LogLevel getConsoleLevel() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sinks[0]->minLevel;
+  }
+};
+
+// One log line, built with << and queued when it goes out of scope:
+//   Log::info() << "Drivers loaded from " << filename;
+class LogLine {
+private:
+  LogLevel level;
+  bool active;
+  std::ostringstream text;
+
+public:
+  explicit LogLine(LogLevel l)
+      : level(l), active(Logger::instance().enabled(l)) {}
+  LogLine(LogLine &&other)
+      : level(other.level), active(other.active),
+        text(std::move(other.text)) {
+    other.active = false;
+  }
+  ~LogLine() {
+    if (active)
+      Logger::instance().push(level, text.str());
+  }
+
+  template <typename T> LogLine &operator<<(const T &value) {
+    if (active)
+      text << value;
+    return *this;
+  }
+  LogLine &operator<<(std::ostream &(*manip)(std::ostream &)) {
+    if (active)
+      text << manip;
+    return *this;
+  }
+  LogLine &operator<<(std::ios_base &(*manip)(std::ios_base &)) {
+    if (active)
+      text << manip;
+    return *this;
+  }
+};
+
+class Log {
+public:
+  static LogLine debug() { return LogLine(LogLevel::Debug); }
+  static LogLine info() { return LogLine(LogLevel::Info); }
+  static LogLine warn() { return LogLine(LogLevel::Warn); }
+  static LogLine error() { return LogLine(LogLevel::Error); }
+  static void flush() { Logger::instance().flush(); }
+};
+
+#endif // LOGGER_H
@@ -2,9 +2,17 @@
 #define MAX_HEAP_H
 
 #include "Driver.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
+// Classification order: score, ties broken by driver id
+inline bool classifiedAhead(const Driver *a, const Driver *b) {
+  if (a->getRankingScore() != b->getRankingScore())
+    return a->getRankingScore() > b->getRankingScore();
+  return a->getId() < b->getId();
+}
+
 class MaxHeap {
 private:
   std::vector<Driver *> heap;
@@ -72,6 +80,22 @@ public:
 
   int size() { return heap.size(); }
 
+  // Removes a specific driver (e.g. retired from the registry mid-season)
+  bool remove(Driver *driver) {
+    for (size_t i = 0; i < heap.size(); ++i) {
+      if (heap[i] == driver) {
+        heap[i] = heap.back();
+        heap.pop_back();
+        if (i < heap.size()) {
+          siftDown(i);
+          siftUp(i);
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
   // For live updates: Rebuilds the heap if scores change externally
   void rebuild() {
     // Start from the last non-leaf node and sift down
@@ -81,6 +105,16 @@ public:
   }
 
   const std::vector<Driver *> &getUnderlyingContainer() const { return heap; }
+
+  // Sorted copy of the heap, P1 first (the heap itself is left untouched)
+  std::vector<Driver *> getOrdered() const {
+    std::vector<Driver *> ordered = heap;
+    std::sort(ordered.begin(), ordered.end(), classifiedAhead);
+    return ordered;
+  }
+
+  // Restores a container previously read via getUnderlyingContainer()
+  void assign(const std::vector<Driver *> &container) { heap = container; }
 };
 
 #endif // MAX_HEAP_H
@@ -0,0 +1,114 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Approximate heap accounting for the engine's stores. Sizes are computed
+// from container capacities and element sizes (allocator overhead is not
+// included), which is enough to see which structure dominates.
+namespace MemoryAccounting {
+
+// Strings up to this capacity live inside the object (small string buffer)
+const size_t SSO_CAPACITY = 15;
+
+inline size_t stringHeap(const std::string &s) {
+  return s.capacity() > SSO_CAPACITY ? s.capacity() + 1 : 0;
+}
+
+template <typename T> size_t vectorHeap(const std::vector<T> &v) {
+  return v.capacity() * sizeof(T);
+}
+
+struct Usage {
+  size_t bytes = 0;
+  size_t objects = 0;
+
+  void add(size_t b, size_t o = 0) {
+    bytes += b;
+    objects += o;
+  }
+};
+
+struct Entry {
+  std::string structure;
+  int raceId; // -1 = season-wide
+  Usage usage;
+};
+
+class Report {
+private:
+  std::vector<Entry> entries;
+
+public:
+  void add(const std::string &structure, int raceId, const Usage &usage) {
+    entries.push_back({structure, raceId, usage});
+  }
+
+  const std::vector<Entry> &getEntries() const { return entries; }
+
+  size_t totalBytes() const {
+    size_t total = 0;
+    for (const Entry &e : entries)
+      total += e.usage.bytes;
+    return total;
+  }
+
+  Usage forRace(int raceId) const {
+    Usage u;
+    for (const Entry &e : entries) {
+      if (e.raceId == raceId)
+        u.add(e.usage.bytes, e.usage.objects);
+    }
+    return u;
+  }
+
+  Usage forStructure(const std::string &structure) const {
+    Usage u;
+    for (const Entry &e : entries) {
+      if (e.structure == structure)
+        u.add(e.usage.bytes, e.usage.objects);
+    }
+    return u;
+  }
+
+  // Per structure totals, then per race totals
+  void print(std::ostream &out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::vector<std::string> structures;
+    std::vector<int> races;
+    for (const Entry &e : entries) {
+      if (std::find(structures.begin(), structures.end(), e.structure) ==
+          structures.end())
+        structures.push_back(e.structure);
+      if (e.raceId >= 0 &&
+          std::find(races.begin(), races.end(), e.raceId) == races.end())
+        races.push_back(e.raceId);
+    }
+
+    std::sort(races.begin(), races.end());
+
+    out << "Structure            Bytes      Objects" << std::endl;
+    for (const std::string &name : structures) {
+      Usage u = forStructure(name);
+      out << std::left << std::setw(20) << name << std::right << std::setw(10)
+          << u.bytes << std::setw(13) << u.objects << std::endl;
+    }
+    for (int raceId : races) {
+      Usage u = forRace(raceId);
+      out << std::left << std::setw(20) << ("race " + std::to_string(raceId))
+          << std::right << std::setw(10) << u.bytes << std::setw(13)
+          << u.objects << std::endl;
+    }
+    out << std::left << std::setw(20) << "total" << std::right
+        << std::setw(10) << totalBytes() << std::endl;
+    out.flags(flags);
+  }
+};
+
+} // namespace MemoryAccounting
+
+#endif // MEMORY_ACCOUNTING_H
@@ -0,0 +1,284 @@
+#ifndef PACE_STATS_H
+#define PACE_STATS_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Incremental per-driver pace statistics. Every update is O(1):
+// - running mean / variance via Welford's algorithm
+// - rolling stddev over the last `windowSize` laps (ring buffer with running
+//   sum and sum of squares)
+// - personal best lap
+class RollingPaceStats {
+private:
+  int laps;
+  double mean;
+  double m2; // Sum of squared deviations (Welford)
+
+  float personalBest;
+  int personalBestLap;
+  float lastLapTime;
+
+  std::vector<float> window;
+  int head;
+  int filled;
+  double windowSum;
+  double windowSumSq;
+
+public:
+  RollingPaceStats(int windowSize = 5)
+      : laps(0), mean(0.0), m2(0.0), personalBest(0.0f), personalBestLap(-1),
+        lastLapTime(0.0f), head(0), filled(0), windowSum(0.0),
+        windowSumSq(0.0) {
+    window.resize(windowSize > 0 ? windowSize : 1, 0.0f);
+  }
+
+  void addLap(float time, int lap) {
+    // Welford
+    laps++;
+    double delta = time - mean;
+    mean += delta / laps;
+    m2 += delta * (time - mean);
+
+    // Rolling window
+    if (filled == (int)window.size()) {
+      float evicted = window[head];
+      windowSum -= evicted;
+      windowSumSq -= (double)evicted * evicted;
+    } else {
+      filled++;
+    }
+    window[head] = time;
+    windowSum += time;
+    windowSumSq += (double)time * time;
+    head = (head + 1) % (int)window.size();
+
+    if (personalBestLap < 0 || time < personalBest) {
+      personalBest = time;
+      personalBestLap = lap;
+    }
+    lastLapTime = time;
+  }
+
+  int getLapCount() const { return laps; }
+  float getMean() const { return (float)mean; }
+  float getVariance() const { return laps > 1 ? (float)(m2 / (laps - 1)) : 0.0f; }
+  float getStdDev() const { return std::sqrt(getVariance()); }
+
+  float getWindowMean() const {
+    return filled > 0 ? (float)(windowSum / filled) : 0.0f;
+  }
+  float getWindowStdDev() const {
+    if (filled < 2)
+      return 0.0f;
+    double var = (windowSumSq - windowSum * windowSum / filled) / (filled - 1);
+    return var > 0.0 ? (float)std::sqrt(var) : 0.0f;
+  }
+  int getWindowSize() const { return (int)window.size(); }
+
+  bool hasPersonalBest() const { return personalBestLap >= 0; }
+  float getPersonalBest() const { return personalBest; }
+  int getPersonalBestLap() const { return personalBestLap; }
+  float getLastLapTime() const { return lastLapTime; }
+};
+
+// State of one driver's pace statistics right after a given lap
+struct PaceSnapshot {
+  int lap;
+  float lapTime;
+  float mean;
+  float stdDev;
+  float windowStdDev;
+  float personalBest;
+  float fieldBest;          // Field fastest lap as of the end of this lap
+  float deltaToPersonalBest;
+  float deltaToFieldBest;
+  float deltaToMean;
+  float deltaToPrevious;    // 0 on the driver's first timed lap
+};
+
+// Pace statistics for a single race. Laps are recorded as they are processed;
+// finalizeLap() then resolves field-relative values once every driver's time
+// for that lap is known, so results do not depend on processing order.
+class PaceTracker {
+private:
+  int windowSize;
+  HashMap<std::string, RollingPaceStats> stats;
+
+  // DriverID -> Snapshots in lap order
+  HashMap<std::string, std::vector<PaceSnapshot>> history;
+
+  float fieldBest;
+  int fieldBestLap;
+  std::string fieldBestDriver;
+
+  // (DriverID, History index) recorded since the last finalize
+  std::vector<std::pair<std::string, int>> pendingDrivers;
+
+public:
+  // Rewind point for partial recomputation. History is append-only, so only
+  // its per-driver length is kept.
+  struct State {
+    HashMap<std::string, RollingPaceStats> stats;
+    HashMap<std::string, int> historyLength;
+    float fieldBest;
+    int fieldBestLap;
+    std::string fieldBestDriver;
+  };
+
+  PaceTracker(int window = 5)
+      : windowSize(window), stats(64), history(64), fieldBest(0.0f),
+        fieldBestLap(-1) {}
+
+  void recordLap(const std::string &driverId, int lap, float time) {
+    if (!stats.contains(driverId)) {
+      stats.put(driverId, RollingPaceStats(windowSize));
+    }
+    RollingPaceStats &s = stats[driverId];
+    bool first = s.getLapCount() == 0;
+    float previous = s.getLastLapTime();
+    s.addLap(time, lap);
+
+    PaceSnapshot snap;
+    snap.lap = lap;
+    snap.lapTime = time;
+    snap.mean = s.getMean();
+    snap.stdDev = s.getStdDev();
+    snap.windowStdDev = s.getWindowStdDev();
+    snap.personalBest = s.getPersonalBest();
+    snap.fieldBest = 0.0f;
+    snap.deltaToPersonalBest = time - s.getPersonalBest();
+    snap.deltaToFieldBest = 0.0f;
+    snap.deltaToMean = time - s.getMean();
+    snap.deltaToPrevious = first ? 0.0f : time - previous;
+    std::vector<PaceSnapshot> &h = history[driverId];
+    h.push_back(snap);
+
+    pendingDrivers.push_back({driverId, (int)h.size() - 1});
+  }
+
+  void finalizeLap(int lap) {
+    (void)lap; // Pending entries carry their own lap
+    finalizePending();
+  }
+
+  // Resolves field-relative values for every lap recorded since the last
+  // call. Entries may span several laps (driver-major batch evaluation);
+  // they are resolved lap by lap, in recording order within a lap.
+  void finalizePending() {
+    std::vector<std::pair<int, size_t>> order; // (lap, pending index)
+    for (size_t i = 0; i < pendingDrivers.size(); ++i) {
+      order.push_back({history[pendingDrivers[i].first][pendingDrivers[i].second].lap, i});
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const std::pair<int, size_t> &a,
+                        const std::pair<int, size_t> &b) {
+                       return a.first < b.first;
+                     });
+
+    size_t begin = 0;
+    while (begin < order.size()) {
+      size_t end = begin;
+      while (end < order.size() && order[end].first == order[begin].first)
+        end++;
+      for (size_t k = begin; k < end; ++k) {
+        const auto &p = pendingDrivers[order[k].second];
+        const PaceSnapshot &snap = history[p.first][p.second];
+        if (fieldBestLap < 0 || snap.lapTime < fieldBest) {
+          fieldBest = snap.lapTime;
+          fieldBestLap = snap.lap;
+          fieldBestDriver = p.first;
+        }
+      }
+      for (size_t k = begin; k < end; ++k) {
+        const auto &p = pendingDrivers[order[k].second];
+        PaceSnapshot &snap = history[p.first][p.second];
+        snap.fieldBest = fieldBest;
+        snap.deltaToFieldBest = snap.lapTime - fieldBest;
+      }
+      begin = end;
+    }
+    pendingDrivers.clear();
+  }
+
+  const RollingPaceStats *getStats(const std::string &driverId) {
+    if (!stats.contains(driverId))
+      return nullptr;
+    return &stats[driverId];
+  }
+
+  // Latest snapshot at or before `lap` (false if no timed lap yet)
+  bool getSnapshot(const std::string &driverId, int lap, PaceSnapshot &out) {
+    if (!history.contains(driverId))
+      return false;
+    const std::vector<PaceSnapshot> &h = history[driverId];
+    int lo = 0, hi = (int)h.size() - 1, found = -1;
+    while (lo <= hi) {
+      int mid = (lo + hi) / 2;
+      if (h[mid].lap <= lap) {
+        found = mid;
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    if (found < 0)
+      return false;
+    out = h[found];
+    return true;
+  }
+
+  State saveState() {
+    State st;
+    st.stats = stats;
+    history.forEach([&](const std::string &id, std::vector<PaceSnapshot> &h) {
+      st.historyLength.put(id, (int)h.size());
+    });
+    st.fieldBest = fieldBest;
+    st.fieldBestLap = fieldBestLap;
+    st.fieldBestDriver = fieldBestDriver;
+    return st;
+  }
+
+  void restoreState(const State &st) {
+    stats = st.stats;
+    history.forEach([&](const std::string &id, std::vector<PaceSnapshot> &h) {
+      const int *len = st.historyLength.find(id);
+      h.resize(len ? *len : 0);
+    });
+    fieldBest = st.fieldBest;
+    fieldBestLap = st.fieldBestLap;
+    fieldBestDriver = st.fieldBestDriver;
+    pendingDrivers.clear();
+  }
+
+  bool hasFieldBest() const { return fieldBestLap >= 0; }
+  float getFieldBest() const { return fieldBest; }
+  int getFieldBestLap() const { return fieldBestLap; }
+  std::string getFieldBestDriver() const { return fieldBestDriver; }
+  int getWindowSize() const { return windowSize; }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(stats.footprint() + history.footprint() + vectorHeap(pendingDrivers));
+    stats.forEach([&](const std::string &id, const RollingPaceStats &s) {
+      u.add(stringHeap(id) + s.getWindowSize() * sizeof(float));
+    });
+    history.forEach(
+        [&](const std::string &id, const std::vector<PaceSnapshot> &h) {
+          u.add(stringHeap(id) + vectorHeap(h), h.size());
+        });
+    return u;
+  }
+
+  template <typename Func> void forEachHistory(Func func) {
+    history.forEach(func);
+  }
+};
+
+#endif // PACE_STATS_H
@@ -0,0 +1,97 @@
+#ifndef PARALLEL_LOADER_H
+#define PARALLEL_LOADER_H
+
+#include "EventParser.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+// Chunked multi-threaded tape parsing. The tape is split into newline-aligned
+// chunks, each parsed on its own thread into a thread-local buffer. Buffers
+// keep events bucketed by race in file order, so replaying chunk 0..N-1 per
+// race reproduces the serial loader's event order exactly.
+namespace ParallelLoader {
+
+struct ParsedEvent {
+  int lap;
+  std::string driverId;
+  Event ev;
+};
+
+struct ParsedMeta {
+  MetaKind kind;
+  int raceId;
+  std::string text;
+  float value;
+};
+
+struct ChunkBuffer {
+  std::vector<std::vector<ParsedEvent>> byRace; // RaceID -> Events
+  std::vector<ParsedMeta> meta;                 // In file order
+  size_t lines = 0;
+};
+
+// Chunk boundaries: each chunk starts right after a newline (or at 0)
+inline std::vector<size_t> splitChunks(const std::string &data, int chunks) {
+  std::vector<size_t> bounds;
+  bounds.push_back(0);
+  for (int i = 1; i < chunks; ++i) {
+    size_t target = data.size() * i / chunks;
+    if (target < bounds.back())
+      target = bounds.back();
+    size_t nl = data.find('\n', target);
+    size_t start = (nl == std::string::npos) ? data.size() : nl + 1;
+    bounds.push_back(start);
+  }
+  bounds.push_back(data.size());
+  return bounds;
+}
+
+inline void parseChunk(const std::string &data, size_t begin, size_t end,
+                       ChunkBuffer &out) {
+  std::string line;
+  size_t pos = begin;
+  while (pos < end) {
+    size_t eol = data.find('\n', pos);
+    if (eol == std::string::npos || eol > end)
+      eol = end;
+    line.assign(data, pos, eol - pos);
+    pos = eol + 1;
+    out.lines++;
+
+    EventParser::parseLine(
+        line,
+        [&](int raceId, int lap, const std::string &driverId,
+            const Event &ev) {
+          if (raceId < 0)
+            return;
+          if (raceId >= (int)out.byRace.size())
+            out.byRace.resize(raceId + 1);
+          out.byRace[raceId].push_back({lap, driverId, ev});
+        },
+        [&](MetaKind kind, int raceId, const std::string &text,
+            float value) { out.meta.push_back({kind, raceId, text, value}); });
+  }
+}
+
+// Parses the whole tape with `threads` workers (one chunk per worker)
+inline std::vector<ChunkBuffer> parse(const std::string &data, int threads) {
+  if (threads < 1)
+    threads = 1;
+  std::vector<size_t> bounds = splitChunks(data, threads);
+  std::vector<ChunkBuffer> buffers(threads);
+
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; ++t) {
+    workers.emplace_back(parseChunk, std::cref(data), bounds[t], bounds[t + 1],
+                         std::ref(buffers[t]));
+  }
+  parseChunk(data, bounds[0], bounds[1], buffers[0]); // Calling thread
+  for (auto &w : workers)
+    w.join();
+  return buffers;
+}
+
+} // namespace ParallelLoader
+
+#endif // PARALLEL_LOADER_H
@@ -0,0 +1,331 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "HashMap.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters read around engine phases
+enum PerfCounter {
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_COUNTER_COUNT
+};
+
+inline const char *perfCounterName(int c) {
+  static const char *names[PERF_COUNTER_COUNT] = {
+      "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses"};
+  return names[c];
+}
+
+// One sample of every counter (plus wall time). `valid` has bit c set when
+// counter c could be read.
+struct PerfReading {
+  uint64_t values[PERF_COUNTER_COUNT];
+  unsigned valid;
+  int64_t wallNs;
+
+  PerfReading() : valid(0), wallNs(0) {
+    std::memset(values, 0, sizeof(values));
+  }
+
+  bool has(int c) const { return (valid >> c) & 1u; }
+
+  // this - earlier (counters valid in both)
+  PerfReading since(const PerfReading &earlier) const {
+    PerfReading d;
+    d.valid = valid & earlier.valid;
+    d.wallNs = wallNs - earlier.wallNs;
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+      if (d.has(c))
+        d.values[c] = values[c] - earlier.values[c];
+    }
+    return d;
+  }
+
+  // Sum; a counter stays valid only if it was read every time
+  void add(const PerfReading &other) {
+    valid &= other.valid;
+    wallNs += other.wallNs;
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+      values[c] += other.values[c];
+  }
+};
+
+// Per-thread hardware counters via perf_event_open (user space only, so it
+// also works with perf_event_paranoid = 2). Each counter is opened on its
+// own, so a CPU without e.g. an LLC event still reports the others; counters
+// that were multiplexed are scaled by enabled/running time. Anything that
+// cannot be opened (non-Linux, containers, paranoid = 3) is simply missing
+// from the readings: wall time is always available.
+class PerfCounters {
+private:
+  int fds[PERF_COUNTER_COUNT];
+  std::string unavailableReason;
+  std::chrono::steady_clock::time_point start;
+
+#ifdef __linux__
+  static int openCounter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Calling thread, any CPU
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  static uint64_t cacheConfig(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+#endif
+
+public:
+  PerfCounters() : start(std::chrono::steady_clock::now()) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+      fds[c] = -1;
+#ifdef __linux__
+    const uint32_t types[PERF_COUNTER_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    const uint64_t configs[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        cacheConfig(PERF_COUNT_HW_CACHE_L1D),
+        cacheConfig(PERF_COUNT_HW_CACHE_LL), PERF_COUNT_HW_BRANCH_MISSES};
+    int firstErrno = 0;
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+      fds[c] = openCounter(types[c], configs[c]);
+      if (fds[c] < 0 && firstErrno == 0)
+        firstErrno = errno;
+    }
+    if (openCount() == 0) {
+      unavailableReason =
+          std::string("perf_event_open: ") + std::strerror(firstErrno);
+      if (firstErrno == EACCES || firstErrno == EPERM)
+        unavailableReason += " (check /proc/sys/kernel/perf_event_paranoid)";
+      else if (firstErrno == ENOENT || firstErrno == EOPNOTSUPP)
+        unavailableReason += " (no hardware PMU, e.g. inside a VM)";
+    }
+#else
+    unavailableReason = "hardware counters are only supported on Linux";
+#endif
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+      if (fds[c] >= 0)
+        close(fds[c]);
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  int openCount() const {
+    int n = 0;
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+      n += fds[c] >= 0;
+    return n;
+  }
+  bool isOpen(int c) const { return fds[c] >= 0; }
+  const std::string &getUnavailableReason() const { return unavailableReason; }
+
+  PerfReading read() const {
+    PerfReading r;
+    r.wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+#ifdef __linux__
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+      if (fds[c] < 0)
+        continue;
+      uint64_t data[3]; // value, time enabled, time running
+      if (::read(fds[c], data, sizeof(data)) != (ssize_t)sizeof(data))
+        continue;
+      uint64_t value = data[0];
+      if (data[2] > 0 && data[2] < data[1])
+        value = (uint64_t)((double)value * data[1] / data[2]);
+      else if (data[2] == 0)
+        continue; // Never scheduled
+      r.values[c] = value;
+      r.valid |= 1u << c;
+    }
+#endif
+    return r;
+  }
+};
+
+// Counter totals per named phase ("load", "lap", "endRace", ...) plus an
+// optional per-lap series. begin()/end() bracket one execution of a phase:
+//
+//   PerfReading t = profiler.begin();
+//   season.processRaceLap(race, lap);
+//   profiler.endLap(t, race, lap, season.getLapEventCount(race, lap));
+//
+// Only the calling thread is counted (the logger and export threads are not).
+class PerfProfiler {
+public:
+  struct Phase {
+    std::string name;
+    PerfReading total;
+    long long calls = 0;
+    long long events = 0;
+  };
+
+  struct LapRow {
+    int raceId;
+    int lap;
+    long long events;
+    PerfReading delta;
+  };
+
+private:
+  PerfCounters counters;
+  std::vector<Phase> phases; // First-use order
+  HashMap<std::string, int> phaseIndex;
+  std::vector<LapRow> laps;
+
+  Phase &phase(const std::string &name) {
+    const int *idx = phaseIndex.find(name);
+    if (idx)
+      return phases[*idx];
+    phaseIndex.put(name, (int)phases.size());
+    phases.emplace_back();
+    phases.back().name = name;
+    return phases.back();
+  }
+
+  static void printRatio(std::ostream &out, bool ok, double value, int width,
+                         int precision) {
+    if (ok)
+      out << std::setw(width) << std::fixed << std::setprecision(precision)
+          << value;
+    else
+      out << std::setw(width) << "n/a";
+  }
+
+public:
+  PerfProfiler() : phaseIndex(16) {}
+
+  const PerfCounters &getCounters() const { return counters; }
+  const std::vector<Phase> &getPhases() const { return phases; }
+  const std::vector<LapRow> &getLaps() const { return laps; }
+
+  PerfReading begin() const { return counters.read(); }
+
+  PerfReading end(const PerfReading &started, const std::string &name,
+                  long long events = 0) {
+    PerfReading delta = counters.read().since(started);
+    Phase &p = phase(name);
+    if (p.calls == 0)
+      p.total.valid = delta.valid;
+    p.total.add(delta);
+    p.calls++;
+    p.events += events;
+    return delta;
+  }
+
+  // A "lap" phase execution that is also kept as its own row
+  void endLap(const PerfReading &started, int raceId, int lap,
+              long long events) {
+    laps.push_back({raceId, lap, events, end(started, "lap", events)});
+  }
+
+  // Phase table: wall time, IPC and misses per event (per 1k instructions
+  // when a phase has no events)
+  void print(std::ostream &out) const {
+    std::ios::fmtflags flags = out.flags();
+    if (counters.openCount() == 0) {
+      out << "Hardware counters unavailable (" << counters.getUnavailableReason()
+          << "); wall time only\n";
+    } else if (counters.openCount() < PERF_COUNTER_COUNT) {
+      out << "Unsupported counters:";
+      for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+        if (!counters.isOpen(c))
+          out << " " << perfCounterName(c);
+      }
+      out << "\n";
+    }
+
+    out << std::left << std::setw(12) << "Phase" << std::right
+        << std::setw(8) << "Calls" << std::setw(10) << "Events"
+        << std::setw(11) << "ms" << std::setw(7) << "IPC" << std::setw(12)
+        << "L1d/ev" << std::setw(12) << "LLC/ev" << std::setw(12) << "Br/ev"
+        << "\n";
+    for (const Phase &p : phases) {
+      const PerfReading &t = p.total;
+      bool perEvent = p.events > 0;
+      double denom = perEvent ? (double)p.events
+                              : (double)t.values[PERF_INSTRUCTIONS] / 1000.0;
+      bool denomOk = perEvent || (t.has(PERF_INSTRUCTIONS) && denom > 0);
+
+      out << std::left << std::setw(12) << p.name << std::right
+          << std::setw(8) << p.calls << std::setw(10) << p.events
+          << std::setw(11) << std::fixed << std::setprecision(2)
+          << t.wallNs / 1e6;
+      printRatio(out,
+                 t.has(PERF_CYCLES) && t.has(PERF_INSTRUCTIONS) &&
+                     t.values[PERF_CYCLES] > 0,
+                 (double)t.values[PERF_INSTRUCTIONS] /
+                     (double)(t.values[PERF_CYCLES] ? t.values[PERF_CYCLES] : 1),
+                 7, 2);
+      const int missCounters[3] = {PERF_L1D_MISSES, PERF_LLC_MISSES,
+                                   PERF_BRANCH_MISSES};
+      for (int c : missCounters) {
+        printRatio(out, denomOk && t.has(c),
+                   (double)t.values[c] / (denomOk && denom > 0 ? denom : 1.0),
+                   12, 3);
+      }
+      out << (!perEvent && denomOk ? "  (per 1k instr)" : "") << "\n";
+    }
+    out.flags(flags);
+  }
+
+  // race,lap,events,ns,<counter...> (empty cells for missing counters)
+  bool exportLapsCsv(const std::string &filename) const {
+    FILE *f = std::fopen(filename.c_str(), "w");
+    if (!f)
+      return false;
+    std::fprintf(f, "race,lap,events,ns");
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+      std::fprintf(f, ",%s", perfCounterName(c));
+    std::fprintf(f, "\n");
+    for (const LapRow &row : laps) {
+      std::fprintf(f, "%d,%d,%lld,%lld", row.raceId, row.lap, row.events,
+                   (long long)row.delta.wallNs);
+      for (int c = 0; c < PERF_COUNTER_COUNT; ++c) {
+        if (row.delta.has(c))
+          std::fprintf(f, ",%llu", (unsigned long long)row.delta.values[c]);
+        else
+          std::fprintf(f, ",");
+      }
+      std::fprintf(f, "\n");
+    }
+    return std::fclose(f) == 0;
+  }
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,186 @@
+#ifndef RACE_EVENT_INDEX_H
+#define RACE_EVENT_INDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Byte-offset index over an event tape: RaceID -> byte ranges holding that
+// race's lines (metadata included). Stored next to the tape as
+// "<tape>.idx" and reused while the tape's size and mtime are unchanged.
+//
+// Sidecar format (text):
+//   RLIDX 1
+//   <tape size> <tape mtime>
+//   <raceId>,<start>,<end>      one line per contiguous range
+class RaceEventIndex {
+public:
+  struct Range {
+    uint64_t start;
+    uint64_t end; // Exclusive
+  };
+
+private:
+  std::vector<std::vector<Range>> ranges; // RaceID -> Ranges in file order
+  uint64_t tapeSize;
+  long long tapeTime;
+
+  static int raceIdOfLine(const std::string &line) {
+    size_t begin = line.rfind("BATCH,", 0) == 0 ? 6 : 0;
+    size_t comma = line.find(',', begin);
+    if (comma == std::string::npos)
+      return -1;
+    try {
+      return std::stoi(line.substr(begin, comma - begin));
+    } catch (...) {
+      return -1;
+    }
+  }
+
+  void addRange(int raceId, uint64_t start, uint64_t end) {
+    if (raceId >= (int)ranges.size())
+      ranges.resize(raceId + 1);
+    std::vector<Range> &r = ranges[raceId];
+    if (!r.empty() && r.back().end == start) {
+      r.back().end = end; // Extend contiguous run
+    } else {
+      r.push_back({start, end});
+    }
+  }
+
+  static bool stat(const std::string &tape, uint64_t &size, long long &time) {
+    std::error_code ec;
+    size = std::filesystem::file_size(tape, ec);
+    if (ec)
+      return false;
+    auto mtime = std::filesystem::last_write_time(tape, ec);
+    if (ec)
+      return false;
+    time = (long long)mtime.time_since_epoch().count();
+    return true;
+  }
+
+  bool build(const std::string &tape) {
+    std::ifstream file(tape, std::ios::binary);
+    if (!file.is_open())
+      return false;
+    ranges.clear();
+    uint64_t offset = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+      uint64_t next = offset + line.size() + (file.eof() ? 0 : 1);
+      int raceId = raceIdOfLine(line);
+      if (raceId >= 0)
+        addRange(raceId, offset, next);
+      offset = next;
+    }
+    return true;
+  }
+
+  bool loadSidecar(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+      return false;
+    std::string magic;
+    int version = 0;
+    uint64_t size = 0;
+    long long time = 0;
+    if (!(file >> magic >> version >> size >> time) || magic != "RLIDX" ||
+        version != 1 || size != tapeSize || time != tapeTime)
+      return false;
+
+    ranges.clear();
+    std::string line;
+    std::getline(file, line); // Rest of header line
+    while (std::getline(file, line)) {
+      std::stringstream ss(line);
+      std::string raceStr, startStr, endStr;
+      if (!std::getline(ss, raceStr, ',') || !std::getline(ss, startStr, ',') ||
+          !std::getline(ss, endStr, ','))
+        continue;
+      try {
+        uint64_t start = std::stoull(startStr), end = std::stoull(endStr);
+        if (start > end || end > tapeSize)
+          return false;
+        addRange(std::stoi(raceStr), start, end);
+      } catch (...) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void saveSidecar(const std::string &path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+      return; // Read-only location: index stays in memory
+    file << "RLIDX 1\n" << tapeSize << " " << tapeTime << "\n";
+    for (size_t raceId = 0; raceId < ranges.size(); ++raceId) {
+      for (const Range &r : ranges[raceId]) {
+        file << raceId << "," << r.start << "," << r.end << "\n";
+      }
+    }
+  }
+
+public:
+  RaceEventIndex() : tapeSize(0), tapeTime(0) {}
+
+  static std::string sidecarPath(const std::string &tape) {
+    return tape + ".idx";
+  }
+
+  // Loads the sidecar if it matches the tape, otherwise scans the tape once
+  // and writes a fresh sidecar. Returns false if the tape cannot be read.
+  // `rebuilt` reports whether a scan was needed.
+  bool open(const std::string &tape, bool &rebuilt) {
+    rebuilt = false;
+    if (!stat(tape, tapeSize, tapeTime))
+      return false;
+    if (loadSidecar(sidecarPath(tape)))
+      return true;
+    if (!build(tape))
+      return false;
+    saveSidecar(sidecarPath(tape));
+    rebuilt = true;
+    return true;
+  }
+
+  bool hasRace(int raceId) const {
+    return raceId >= 0 && raceId < (int)ranges.size() &&
+           !ranges[raceId].empty();
+  }
+
+  const std::vector<Range> &rangesFor(int raceId) const {
+    static const std::vector<Range> none;
+    return hasRace(raceId) ? ranges[raceId] : none;
+  }
+
+  // Reads every line of one race, in file order
+  template <typename Func>
+  bool forEachLine(const std::string &tape, int raceId, Func func) const {
+    std::ifstream file(tape, std::ios::binary);
+    if (!file.is_open())
+      return false;
+    std::string chunk;
+    for (const Range &r : rangesFor(raceId)) {
+      chunk.resize(r.end - r.start);
+      file.seekg(r.start);
+      if (!file.read(&chunk[0], chunk.size()))
+        return false;
+      size_t pos = 0;
+      while (pos < chunk.size()) {
+        size_t eol = chunk.find('\n', pos);
+        if (eol == std::string::npos)
+          eol = chunk.size();
+        func(chunk.substr(pos, eol - pos));
+        pos = eol + 1;
+      }
+    }
+    return true;
+  }
+};
+
+#endif // RACE_EVENT_INDEX_H
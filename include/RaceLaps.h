@@ -0,0 +1,154 @@
+#ifndef RACE_LAPS_H
+#define RACE_LAPS_H
+
+#include "SeasonManager.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Classification right after one lap
+struct LapSnapshot {
+  int raceId;
+  int lap;
+  int totalLaps;
+  std::vector<std::string> order; // DriverIDs, P1 first (participants only)
+  std::string leader;
+  std::string previousLeader;     // Empty on the first lap
+  bool leaderChanged;
+};
+
+// Lazy lap-by-lap view of one race. Laps are computed only as the consumer
+// advances, so breaking out of the loop skips the remaining laps:
+//
+//   for (const LapSnapshot &snap : RaceLaps(season, 3)) {
+//     if (snap.lap == 10) break;    // Laps 11+ are never processed
+//   }
+//
+// begin() starts the race; endRace() is left to the caller (results only
+// make sense once every lap has been processed).
+class RaceLaps {
+private:
+  SeasonManager *season;
+  int raceId;
+  int totalLaps;
+  int nextLap;
+  bool started;
+  LapSnapshot current;
+
+  bool advance() {
+    if (nextLap > totalLaps)
+      return false;
+    season->processRaceLap(raceId, nextLap);
+
+    current.lap = nextLap;
+    current.previousLeader = current.leader;
+    current.order.clear();
+    for (Driver *d : season->getLeaderboard()->getOrdered()) {
+      if (d->didParticipate())
+        current.order.push_back(d->getId());
+    }
+    current.leader = current.order.empty() ? "" : current.order[0];
+    current.leaderChanged = current.leader != current.previousLeader;
+    nextLap++;
+    return true;
+  }
+
+public:
+  class iterator {
+  private:
+    RaceLaps *owner; // nullptr = end
+
+  public:
+    explicit iterator(RaceLaps *r = nullptr) : owner(r) {}
+    const LapSnapshot &operator*() const { return owner->current; }
+    const LapSnapshot *operator->() const { return &owner->current; }
+    iterator &operator++() {
+      if (!owner->advance())
+        owner = nullptr;
+      return *this;
+    }
+    bool operator==(const iterator &other) const {
+      return owner == other.owner;
+    }
+    bool operator!=(const iterator &other) const {
+      return owner != other.owner;
+    }
+  };
+
+  RaceLaps(SeasonManager &s, int race)
+      : season(&s), raceId(race), totalLaps(s.getRaceLapCount(race)),
+        nextLap(0), started(false) {
+    current.raceId = race;
+    current.lap = -1;
+    current.totalLaps = totalLaps;
+    current.leaderChanged = false;
+  }
+
+  // Single pass: a second begin() continues where the last one stopped
+  iterator begin() {
+    if (!started) {
+      season->startRace(raceId);
+      started = true;
+    }
+    return advance() ? iterator(this) : end();
+  }
+  iterator end() { return iterator(); }
+
+  int getLapsComputed() const { return nextLap; }
+};
+
+// Lazy filter over any lap range (RaceLaps or another filter). An lvalue
+// range is referenced, a temporary is moved into the filter.
+template <typename Range, typename Pred> class FilteredLaps {
+private:
+  Range range;
+  Pred pred;
+
+  typedef decltype(std::declval<typename std::remove_reference<Range>::type &>()
+                       .begin()) BaseIterator;
+
+public:
+  class iterator {
+  private:
+    BaseIterator it;
+    BaseIterator last;
+    Pred *pred;
+
+    void skip() {
+      while (it != last && !(*pred)(*it))
+        ++it;
+    }
+
+  public:
+    iterator(BaseIterator begin, BaseIterator end, Pred *p)
+        : it(begin), last(end), pred(p) {
+      skip();
+    }
+    const LapSnapshot &operator*() const { return *it; }
+    const LapSnapshot *operator->() const { return &*it; }
+    iterator &operator++() {
+      ++it;
+      skip();
+      return *this;
+    }
+    bool operator==(const iterator &other) const { return it == other.it; }
+    bool operator!=(const iterator &other) const { return it != other.it; }
+  };
+
+  FilteredLaps(Range &&r, Pred p) : range(std::forward<Range>(r)), pred(p) {}
+
+  iterator begin() { return iterator(range.begin(), range.end(), &pred); }
+  iterator end() { return iterator(range.end(), range.end(), &pred); }
+};
+
+template <typename Range, typename Pred>
+FilteredLaps<Range, Pred> filterLaps(Range &&range, Pred pred) {
+  return FilteredLaps<Range, Pred>(std::forward<Range>(range), pred);
+}
+
+// Common filters
+inline bool leaderChanged(const LapSnapshot &snap) {
+  return snap.leaderChanged;
+}
+
+#endif // RACE_LAPS_H
@@ -0,0 +1,121 @@
+#ifndef RESULT_CORRECTION_H
+#define RESULT_CORRECTION_H
+
+#include "SeasonExport.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Points for a classified position (0 = winner), as awarded by endRace
+inline int racePointsFor(size_t index) {
+  static const int points[] = {25, 18, 15, 12, 10, 8, 6, 4, 2, 1};
+  return index < 10 ? points[index] : 0;
+}
+
+enum class CorrectionType {
+  TimePenalty,     // Seconds added to the race time (negative = rescinded)
+  Disqualification // Excluded from the classification, no points
+};
+
+// One stewards' decision against a finished race
+struct ResultCorrection {
+  CorrectionType type = CorrectionType::TimePenalty;
+  int raceId = 0;
+  std::string driverId;
+  float seconds = 0.0f;
+
+  // One decision per line:
+  //   PENALTY,<race>,<driver>,+5s   (trailing "s" optional, -5s rescinds)
+  //   DSQ,<race>,<driver>
+  static bool parse(const std::string &line, ResultCorrection &out,
+                    std::string &error) {
+    std::stringstream ss(line);
+    std::string kind, raceStr, amount;
+    out = ResultCorrection();
+    if (!std::getline(ss, kind, ',') || !std::getline(ss, raceStr, ',') ||
+        !std::getline(ss, out.driverId, ',') || out.driverId.empty()) {
+      error = "Malformed correction: " + line;
+      return false;
+    }
+    try {
+      out.raceId = std::stoi(raceStr);
+      if (kind == "PENALTY") {
+        if (!std::getline(ss, amount, ',') || amount.empty()) {
+          error = "Penalty without seconds: " + line;
+          return false;
+        }
+        if (amount.back() == 's')
+          amount.pop_back();
+        out.type = CorrectionType::TimePenalty;
+        out.seconds = std::stof(amount);
+      } else if (kind == "DSQ") {
+        out.type = CorrectionType::Disqualification;
+      } else {
+        error = "Unknown correction type: " + kind;
+        return false;
+      }
+    } catch (...) {
+      error = "Bad number in: " + line;
+      return false;
+    }
+    return true;
+  }
+
+  // "+5s", "DSQ"
+  std::string describe() const {
+    if (type == CorrectionType::Disqualification)
+      return "DSQ";
+    std::ostringstream out;
+    out << (seconds >= 0.0f ? "+" : "") << seconds << "s";
+    return out.str();
+  }
+};
+
+// Applies `c` to the driver named `name` and reclassifies only this race
+// from its stored results. A time penalty moves the driver behind every
+// finisher whose corrected time is lower (or ahead, if rescinded); nobody
+// else changes order. A disqualified driver drops to the end of the table
+// and everyone behind moves up. Positions and points are then renumbered.
+inline bool reclassifyRace(RaceResult &race, const std::string &name,
+                           const ResultCorrection &c, std::string &error) {
+  std::vector<DriverResult> &res = race.results;
+  size_t i = 0;
+  while (i < res.size() && res[i].name != name)
+    i++;
+  if (i == res.size()) {
+    error = name + " is not classified in race " + std::to_string(race.raceId);
+    return false;
+  }
+  if (res[i].status == "DSQ") {
+    error = name + " is already disqualified from race " +
+            std::to_string(race.raceId);
+    return false;
+  }
+
+  DriverResult moved = res[i];
+  res.erase(res.begin() + i);
+  size_t to = i;
+  if (c.type == CorrectionType::Disqualification) {
+    moved.status = "DSQ";
+    to = res.size();
+  } else {
+    moved.totalTime += c.seconds;
+    if (moved.status == "Finished") {
+      while (to < res.size() && res[to].status == "Finished" &&
+             res[to].totalTime <= moved.totalTime)
+        to++;
+      while (to > 0 && res[to - 1].status == "Finished" &&
+             res[to - 1].totalTime > moved.totalTime)
+        to--;
+    }
+  }
+  res.insert(res.begin() + to, moved);
+
+  for (size_t p = 0; p < res.size(); ++p) {
+    res[p].position = (int)p + 1;
+    res[p].points = res[p].status == "DSQ" ? 0 : racePointsFor(p);
+  }
+  return true;
+}
+
+#endif // RESULT_CORRECTION_H
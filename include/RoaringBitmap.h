@@ -0,0 +1,275 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Compressed set of 32-bit row ids, roaring style: ids are split into
+// 65536-wide chunks by their high 16 bits, and each chunk stores its low
+// 16 bits either as a sorted array (sparse, up to 4096 values) or as a
+// 65536-bit bitmap (dense). AND/OR work chunk by chunk on whichever
+// representations meet.
+class RoaringBitmap {
+private:
+  static const size_t ARRAY_MAX = 4096;
+  static const size_t WORDS = 1024; // 65536 bits
+
+  // Index of the lowest set bit (w != 0)
+  static int lowestBit(uint64_t w) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return (int)i;
+#else
+    return __builtin_ctzll(w);
+#endif
+  }
+
+  static int popcount(uint64_t w) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+  }
+
+  struct Container {
+    uint16_t key;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> array; // Sparse form (sorted)
+    std::vector<uint64_t> bits;  // Dense form (WORDS words) when non-empty
+
+    bool isBitmap() const { return !bits.empty(); }
+
+    bool contains(uint16_t low) const {
+      if (isBitmap())
+        return (bits[low >> 6] >> (low & 63)) & 1u;
+      return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    void toBitmap() {
+      bits.assign(WORDS, 0);
+      for (uint16_t v : array)
+        bits[v >> 6] |= 1ull << (v & 63);
+      std::vector<uint16_t>().swap(array);
+    }
+
+    void toArrayIfSparse() {
+      if (!isBitmap() || cardinality > ARRAY_MAX)
+        return;
+      array.clear();
+      array.reserve(cardinality);
+      forEach([&](uint16_t v) { array.push_back(v); });
+      std::vector<uint64_t>().swap(bits);
+    }
+
+    void add(uint16_t low) {
+      if (isBitmap()) {
+        uint64_t &w = bits[low >> 6];
+        uint64_t mask = 1ull << (low & 63);
+        if (!(w & mask)) {
+          w |= mask;
+          cardinality++;
+        }
+        return;
+      }
+      // Ids usually arrive in ascending order: append
+      if (array.empty() || array.back() < low) {
+        array.push_back(low);
+      } else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low)
+          return;
+        array.insert(it, low);
+      }
+      cardinality++;
+      if (cardinality > ARRAY_MAX)
+        toBitmap();
+    }
+
+    template <typename Func> void forEach(Func func) const {
+      if (!isBitmap()) {
+        for (uint16_t v : array)
+          func(v);
+        return;
+      }
+      for (size_t w = 0; w < WORDS; ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+          int bit = lowestBit(word);
+          func((uint16_t)(w * 64 + bit));
+          word &= word - 1;
+        }
+      }
+    }
+  };
+
+  std::vector<Container> containers; // Ascending by key
+
+  static Container intersect(const Container &a, const Container &b) {
+    Container out;
+    out.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+      out.bits.resize(WORDS);
+      for (size_t w = 0; w < WORDS; ++w) {
+        out.bits[w] = a.bits[w] & b.bits[w];
+        out.cardinality += popcount(out.bits[w]);
+      }
+      out.toArrayIfSparse();
+    } else if (a.isBitmap() || b.isBitmap()) {
+      const Container &sparse = a.isBitmap() ? b : a;
+      const Container &dense = a.isBitmap() ? a : b;
+      for (uint16_t v : sparse.array) {
+        if (dense.contains(v))
+          out.array.push_back(v);
+      }
+      out.cardinality = (uint32_t)out.array.size();
+    } else {
+      std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(),
+                            b.array.end(), std::back_inserter(out.array));
+      out.cardinality = (uint32_t)out.array.size();
+    }
+    return out;
+  }
+
+  static Container unite(const Container &a, const Container &b) {
+    Container out;
+    out.key = a.key;
+    if (!a.isBitmap() && !b.isBitmap() &&
+        a.cardinality + b.cardinality <= ARRAY_MAX) {
+      std::set_union(a.array.begin(), a.array.end(), b.array.begin(),
+                     b.array.end(), std::back_inserter(out.array));
+      out.cardinality = (uint32_t)out.array.size();
+      return out;
+    }
+    out.bits.assign(WORDS, 0);
+    for (const Container *c : {&a, &b}) {
+      if (c->isBitmap()) {
+        for (size_t w = 0; w < WORDS; ++w)
+          out.bits[w] |= c->bits[w];
+      } else {
+        for (uint16_t v : c->array)
+          out.bits[v >> 6] |= 1ull << (v & 63);
+      }
+    }
+    for (size_t w = 0; w < WORDS; ++w)
+      out.cardinality += popcount(out.bits[w]);
+    out.toArrayIfSparse();
+    return out;
+  }
+
+public:
+  // [0, n)
+  static RoaringBitmap range(uint32_t n) {
+    RoaringBitmap r;
+    for (uint32_t v = 0; v < n; ++v)
+      r.add(v);
+    return r;
+  }
+
+  void add(uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16);
+    if (containers.empty() || containers.back().key < key) {
+      containers.emplace_back();
+      containers.back().key = key;
+      containers.back().add((uint16_t)value);
+      return;
+    }
+    auto it = std::lower_bound(
+        containers.begin(), containers.end(), key,
+        [](const Container &c, uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) {
+      it = containers.insert(it, Container());
+      it->key = key;
+    }
+    it->add((uint16_t)value);
+  }
+
+  bool contains(uint32_t value) const {
+    uint16_t key = (uint16_t)(value >> 16);
+    auto it = std::lower_bound(
+        containers.begin(), containers.end(), key,
+        [](const Container &c, uint16_t k) { return c.key < k; });
+    return it != containers.end() && it->key == key &&
+           it->contains((uint16_t)value);
+  }
+
+  size_t cardinality() const {
+    size_t n = 0;
+    for (const Container &c : containers)
+      n += c.cardinality;
+    return n;
+  }
+
+  bool empty() const { return cardinality() == 0; }
+
+  RoaringBitmap operator&(const RoaringBitmap &other) const {
+    RoaringBitmap out;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+      const Container &a = containers[i];
+      const Container &b = other.containers[j];
+      if (a.key < b.key) {
+        i++;
+      } else if (b.key < a.key) {
+        j++;
+      } else {
+        Container c = intersect(a, b);
+        if (c.cardinality > 0)
+          out.containers.push_back(std::move(c));
+        i++;
+        j++;
+      }
+    }
+    return out;
+  }
+
+  RoaringBitmap operator|(const RoaringBitmap &other) const {
+    RoaringBitmap out;
+    size_t i = 0, j = 0;
+    while (i < containers.size() || j < other.containers.size()) {
+      if (j == other.containers.size() ||
+          (i < containers.size() && containers[i].key < other.containers[j].key)) {
+        out.containers.push_back(containers[i++]);
+      } else if (i == containers.size() ||
+                 other.containers[j].key < containers[i].key) {
+        out.containers.push_back(other.containers[j++]);
+      } else {
+        out.containers.push_back(unite(containers[i++], other.containers[j++]));
+      }
+    }
+    return out;
+  }
+
+  RoaringBitmap &operator&=(const RoaringBitmap &other) {
+    *this = *this & other;
+    return *this;
+  }
+  RoaringBitmap &operator|=(const RoaringBitmap &other) {
+    *this = *this | other;
+    return *this;
+  }
+
+  // Ascending
+  template <typename Func> void forEach(Func func) const {
+    for (const Container &c : containers) {
+      uint32_t high = (uint32_t)c.key << 16;
+      c.forEach([&](uint16_t low) { func(high | low); });
+    }
+  }
+
+  size_t memoryBytes() const {
+    size_t bytes = containers.capacity() * sizeof(Container);
+    for (const Container &c : containers)
+      bytes += c.array.capacity() * sizeof(uint16_t) +
+               c.bits.capacity() * sizeof(uint64_t);
+    return bytes;
+  }
+};
+
+#endif // ROARING_BITMAP_H
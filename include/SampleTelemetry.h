@@ -0,0 +1,256 @@
+#ifndef SAMPLE_TELEMETRY_H
+#define SAMPLE_TELEMETRY_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One high-frequency car sample (4-10 Hz feed)
+struct TelemetrySample {
+  float t;     // Race elapsed time (s), same clock as the lap elapsed times
+  float speed; // km/h
+  float x;     // Track position (m)
+  float y;
+};
+
+// Aggregate of every sample whose time falls in [index, index + 1) * width
+struct SampleBucket {
+  int64_t index;
+  float minSpeed;
+  float maxSpeed;
+  double sumSpeed;
+  uint32_t count;
+  TelemetrySample last; // Latest sample in the bucket (position for charts)
+
+  float meanSpeed() const { return count ? (float)(sumSpeed / count) : 0.0f; }
+
+  void add(const TelemetrySample &s) {
+    if (count == 0 || s.speed < minSpeed)
+      minSpeed = s.speed;
+    if (count == 0 || s.speed > maxSpeed)
+      maxSpeed = s.speed;
+    sumSpeed += s.speed;
+    if (count == 0 || s.t >= last.t)
+      last = s;
+    count++;
+  }
+
+  void merge(const SampleBucket &o) {
+    minSpeed = std::min(minSpeed, o.minSpeed);
+    maxSpeed = std::max(maxSpeed, o.maxSpeed);
+    sumSpeed += o.sumSpeed;
+    count += o.count;
+    if (o.last.t >= last.t)
+      last = o.last;
+  }
+};
+
+struct SampleLimits {
+  size_t rawCapacity = 4096;  // Latest raw samples kept per driver
+  size_t maxBuckets = 1024;   // Downsampled history per driver
+  float bucketSeconds = 0.5f; // Initial bucket width
+};
+
+// One driver's samples with bounded memory: a fixed-capacity ring of the
+// latest raw samples, plus min/max/mean buckets covering the whole race.
+// When the buckets are full, neighbours are merged pairwise and the width
+// doubles, so the full race always fits in maxBuckets.
+class DriverSampleChannel {
+private:
+  std::vector<TelemetrySample> ring;
+  size_t head;  // Next write position
+  size_t count; // Samples in the ring
+  uint64_t total;
+
+  std::vector<SampleBucket> buckets; // Ascending by index
+  size_t maxBuckets;
+  double width;
+
+  void compact() {
+    width *= 2.0;
+    size_t out = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      SampleBucket b = buckets[i];
+      b.index = (int64_t)std::floor(b.index / 2.0);
+      if (out > 0 && buckets[out - 1].index == b.index) {
+        buckets[out - 1].merge(b);
+      } else {
+        buckets[out++] = b;
+      }
+    }
+    buckets.resize(out);
+  }
+
+public:
+  explicit DriverSampleChannel(const SampleLimits &limits = SampleLimits())
+      : ring(std::max<size_t>(1, limits.rawCapacity)), head(0), count(0),
+        total(0), maxBuckets(std::max<size_t>(2, limits.maxBuckets)),
+        width(limits.bucketSeconds > 0.0f ? limits.bucketSeconds : 0.5) {
+    buckets.reserve(maxBuckets);
+  }
+
+  // Out-of-order samples are folded into their bucket
+  void push(const TelemetrySample &s) {
+    ring[head] = s;
+    head = (head + 1) % ring.size();
+    if (count < ring.size())
+      count++;
+    total++;
+
+    int64_t index = (int64_t)std::floor(s.t / width);
+    auto it = std::lower_bound(
+        buckets.begin(), buckets.end(), index,
+        [](const SampleBucket &b, int64_t i) { return b.index < i; });
+    if (it != buckets.end() && it->index == index) {
+      it->add(s);
+      return;
+    }
+    SampleBucket b{index, 0.0f, 0.0f, 0.0, 0, s};
+    b.add(s);
+    buckets.insert(it, b);
+    while (buckets.size() > maxBuckets)
+      compact();
+  }
+
+  uint64_t getTotalSamples() const { return total; }
+  size_t getRecentCount() const { return count; }
+  double getBucketSeconds() const { return width; }
+  const std::vector<SampleBucket> &getBuckets() const { return buckets; }
+
+  // Oldest first
+  template <typename Func> void forEachRecent(Func func) const {
+    size_t start = (head + ring.size() - count) % ring.size();
+    for (size_t i = 0; i < count; ++i)
+      func(ring[(start + i) % ring.size()]);
+  }
+
+  // Buckets whose start lies in [from, to) (e.g. one lap)
+  SampleBucket aggregate(float from, float to) const {
+    SampleBucket out{0, 0.0f, 0.0f, 0.0, 0, TelemetrySample{0, 0, 0, 0}};
+    for (const SampleBucket &b : buckets) {
+      double start = b.index * width;
+      if (start < from || start >= to)
+        continue;
+      if (out.count == 0) {
+        out = b;
+      } else {
+        out.merge(b);
+      }
+    }
+    return out;
+  }
+
+  size_t memoryBytes() const {
+    return MemoryAccounting::vectorHeap(ring) +
+           MemoryAccounting::vectorHeap(buckets);
+  }
+};
+
+// Largest-Triangle-Three-Buckets: picks `threshold` points of a series
+// (ascending x) that preserve its visual shape. Returns indices.
+inline std::vector<size_t> lttb(const std::vector<float> &x,
+                                const std::vector<float> &y,
+                                size_t threshold) {
+  size_t n = x.size();
+  std::vector<size_t> picked;
+  if (threshold >= n || threshold < 3) {
+    for (size_t i = 0; i < n; ++i)
+      picked.push_back(i);
+    return picked;
+  }
+
+  double every = (double)(n - 2) / (double)(threshold - 2);
+  size_t a = 0;
+  picked.push_back(0);
+  for (size_t i = 0; i < threshold - 2; ++i) {
+    // Average of the next bucket
+    size_t nextStart = (size_t)std::floor((i + 1) * every) + 1;
+    size_t nextEnd = std::min(n, (size_t)std::floor((i + 2) * every) + 1);
+    double avgX = 0.0, avgY = 0.0;
+    for (size_t j = nextStart; j < nextEnd; ++j) {
+      avgX += x[j];
+      avgY += y[j];
+    }
+    size_t span = nextEnd > nextStart ? nextEnd - nextStart : 1;
+    avgX /= span;
+    avgY /= span;
+
+    // Point of this bucket with the largest triangle
+    size_t start = (size_t)std::floor(i * every) + 1;
+    size_t end = (size_t)std::floor((i + 1) * every) + 1;
+    double best = -1.0;
+    size_t bestIndex = start;
+    for (size_t j = start; j < end; ++j) {
+      double area = std::fabs((x[a] - avgX) * (y[j] - y[a]) -
+                              (x[a] - x[j]) * (avgY - y[a]));
+      if (area > best) {
+        best = area;
+        bestIndex = j;
+      }
+    }
+    picked.push_back(bestIndex);
+    a = bestIndex;
+  }
+  picked.push_back(n - 1);
+  return picked;
+}
+
+// Per-race sample store, one bounded channel per driver
+class SampleTelemetry {
+private:
+  SampleLimits limits;
+  std::vector<std::string> driverIds;
+  HashMap<std::string, int> driverSlot;
+  std::vector<DriverSampleChannel> channels;
+
+public:
+  explicit SampleTelemetry(const SampleLimits &l = SampleLimits())
+      : limits(l), driverSlot(64) {}
+
+  void ingest(const std::string &driverId, const TelemetrySample &s) {
+    const int *slot = driverSlot.find(driverId);
+    int idx;
+    if (slot) {
+      idx = *slot;
+    } else {
+      idx = (int)driverIds.size();
+      driverSlot.put(driverId, idx);
+      driverIds.push_back(driverId);
+      channels.emplace_back(limits);
+    }
+    channels[idx].push(s);
+  }
+
+  const DriverSampleChannel *channel(const std::string &driverId) const {
+    const int *slot = driverSlot.find(driverId);
+    return slot ? &channels[*slot] : nullptr;
+  }
+
+  uint64_t getTotalSamples() const {
+    uint64_t n = 0;
+    for (const auto &c : channels)
+      n += c.getTotalSamples();
+    return n;
+  }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(driverSlot.footprint() + vectorHeap(driverIds) + vectorHeap(channels));
+    for (size_t i = 0; i < channels.size(); ++i)
+      u.add(stringHeap(driverIds[i]) * 2 + channels[i].memoryBytes(),
+            channels[i].getRecentCount() + channels[i].getBuckets().size());
+    return u;
+  }
+
+  template <typename Func> void forEachDriver(Func func) const {
+    for (size_t i = 0; i < driverIds.size(); ++i)
+      func(driverIds[i], channels[i]);
+  }
+};
+
+#endif // SAMPLE_TELEMETRY_H
@@ -4,20 +4,75 @@
 #include "Driver.h"
 #include <algorithm>
 #include <cmath>
+#include <string>
+
+// Tunable constants of calculateScore. The defaults are the original
+// hand-picked values; `--sweep` searches for better ones.
+struct ScoringWeights {
+  float tyreLossScale = 3.0f;    // Fitted tyre time loss (s) that costs...
+  float tyrePenalty = 0.5f;      // ...this much efficiency (linear)
+  float wetSkillBonus = 0.2f;    // x wet weather skill, in the wet
+  float softOvertake = 0.8f;     // Overtake potential multiplier on Softs
+  float hardOvertake = 1.3f;     // ... and on Hards
+  float consistencyBonus = 3.0f; // Lap within 0.1s of the previous one
+
+  static const int COUNT = 6;
+  static const char *name(int i) {
+    static const char *names[COUNT] = {"tyreLossScale", "tyrePenalty",
+                                       "wetSkillBonus", "softOvertake",
+                                       "hardOvertake",  "consistencyBonus"};
+    return names[i];
+  }
+  static float ScoringWeights::*field(int i) {
+    static float ScoringWeights::*const fields[COUNT] = {
+        &ScoringWeights::tyreLossScale, &ScoringWeights::tyrePenalty,
+        &ScoringWeights::wetSkillBonus, &ScoringWeights::softOvertake,
+        &ScoringWeights::hardOvertake,  &ScoringWeights::consistencyBonus};
+    return fields[i];
+  }
+  float &operator[](int i) { return this->*field(i); }
+  float operator[](int i) const { return this->*field(i); }
+};
+
+// The driver state calculateScore reads, copied out of a Driver (sweeps
+// replay thousands of weight vectors over recorded laps)
+struct ScoringInput {
+  float currentLapTime;
+  float lastLapTime;
+  int tyreAge;
+  float tyreLoss; // Fitted degradation rate x tyre age (s, >= 0)
+  float wetWeatherSkill;
+  int compound; // 0 = other, 1 = Soft, 2 = Hard
+
+  static ScoringInput from(const Driver *driver) {
+    const std::string &c = driver->getTyreCompound();
+    float loss = std::max(0.0f, driver->getDegradationRate()) *
+                 driver->getTyreAge();
+    return {driver->getCurrentLapTime(), driver->getLastLapTime(),
+            driver->getTyreAge(), loss, driver->getWetWeatherSkill(),
+            c == "Soft" ? 1 : c == "Hard" ? 2 : 0};
+  }
+};
 
 class ScoringEngine {
 public:
   static float calculateScore(Driver *driver, float idealLapTime, float weather,
                               float trackDifficulty) {
+    return calculateScore(ScoringInput::from(driver), idealLapTime, weather,
+                          trackDifficulty, ScoringWeights());
+  }
+
+  static float calculateScore(const ScoringInput &driver, float idealLapTime,
+                              float weather, float trackDifficulty,
+                              const ScoringWeights &w) {
     // 1. Speed Efficiency
-    float actualTime = driver->getCurrentLapTime() > 0
-                           ? driver->getCurrentLapTime()
-                           : idealLapTime * 1.1f;
+    float actualTime = driver.currentLapTime > 0 ? driver.currentLapTime
+                                                 : idealLapTime * 1.1f;
     float speedEfficiency = idealLapTime / actualTime;
 
-    // 2. Tyre Degradation (Non-linear)
+    // 2. Tyre Degradation (fitted per stint, see TyreDegradation.h)
     float tyreDegFactor =
-        1.0f + (std::pow(driver->getTyreAge() / 30.0f, 2) * 0.5f);
+        1.0f + (driver.tyreLoss / w.tyreLossScale) * w.tyrePenalty;
     float tyreAdjustedEfficiency = speedEfficiency / tyreDegFactor;
 
     // 3. Car Handicap (REMOVED)
@@ -26,25 +81,24 @@ public:
     // 4. Weather Skill
     float weatherBonus = 1.0f;
     if (weather > 0.5f) {
-      weatherBonus = 1.0f + (driver->getWetWeatherSkill() * 0.2f);
+      weatherBonus = 1.0f + (driver.wetWeatherSkill * w.wetSkillBonus);
     }
 
     // 5. Overtake Logic
     float overtakePotential = 10.0f * trackDifficulty;
-    if (driver->getTyreCompound() == "Soft")
-      overtakePotential *= 0.8f;
-    if (driver->getTyreCompound() == "Hard")
-      overtakePotential *= 1.3f;
-    if (driver->getTyreAge() > 20)
+    if (driver.compound == 1)
+      overtakePotential *= w.softOvertake;
+    if (driver.compound == 2)
+      overtakePotential *= w.hardOvertake;
+    if (driver.tyreAge > 20)
       overtakePotential += 0.5f;
 
     float aggressionScore = overtakePotential * 0.1f;
 
     // 6. Consistency Bonus
     float consistencyBonus = 0.0f;
-    if (std::abs(driver->getCurrentLapTime() - driver->getLastLapTime()) <
-        0.1f) {
-      consistencyBonus = 3.0f;
+    if (std::abs(driver.currentLapTime - driver.lastLapTime) < 0.1f) {
+      consistencyBonus = w.consistencyBonus;
     }
 
     // Final Calculation
@@ -0,0 +1,223 @@
+#ifndef SCORING_SWEEP_H
+#define SCORING_SWEEP_H
+
+#include "ScoringEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// What calculateScore saw during one recorded race: one ScoringInput per
+// driver per lap with data, grouped by driver, plus the real finishing
+// order. Recorded once (SeasonManager::recordScoringRace) and replayed for
+// every weight vector.
+struct ScoringRace {
+  int raceId = 0;
+  float idealLapTime = 90.0f;
+  float weather = 0.0f;
+  float trackDifficulty = 1.0f;
+  std::vector<std::string> driverIds;
+  std::vector<int> position;          // Driver -> Classified position (1 = P1)
+  std::vector<uint32_t> inputStart;   // Driver -> First input (size + 1)
+  std::vector<ScoringInput> inputs;
+};
+
+// One weight vector's agreement with the real classifications, averaged
+// over races (1 = identical order, -1 = reversed)
+struct SweepResult {
+  ScoringWeights weights;
+  double kendall = 0.0;  // Tau-b
+  double spearman = 0.0; // Rho on average ranks
+};
+
+// Evaluates many ScoringWeights against recorded races in parallel. The
+// prediction for a race ranks drivers by their summed per-lap score.
+class ScoringSweep {
+private:
+  std::vector<ScoringRace> races;
+
+  // Average ranks (ties share the mean of their ranks)
+  static std::vector<double> ranks(const std::vector<double> &v) {
+    std::vector<size_t> order(v.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return v[a] < v[b]; });
+    std::vector<double> r(v.size());
+    for (size_t i = 0; i < order.size();) {
+      size_t j = i;
+      while (j + 1 < order.size() && v[order[j + 1]] == v[order[i]])
+        j++;
+      for (size_t k = i; k <= j; ++k)
+        r[order[k]] = (i + j) / 2.0 + 1.0;
+      i = j + 1;
+    }
+    return r;
+  }
+
+public:
+  // Searched range of every weight (grid end points, random bounds)
+  static void range(int i, float &lo, float &hi) {
+    static const float bounds[ScoringWeights::COUNT][2] = {
+        {0.5f, 6.0f},   {0.0f, 1.0f}, {0.0f, 0.5f},
+        {0.5f, 1.2f},   {0.8f, 1.8f}, {0.0f, 6.0f}};
+    lo = bounds[i][0];
+    hi = bounds[i][1];
+  }
+
+  static double kendallTauB(const std::vector<double> &x,
+                            const std::vector<double> &y) {
+    long long concordant = 0, discordant = 0, tiesX = 0, tiesY = 0;
+    size_t n = x.size();
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = i + 1; j < n; ++j) {
+        double dx = x[i] - x[j], dy = y[i] - y[j];
+        if (dx == 0.0)
+          tiesX++;
+        if (dy == 0.0)
+          tiesY++;
+        if (dx * dy > 0.0)
+          concordant++;
+        else if (dx * dy < 0.0)
+          discordant++;
+      }
+    }
+    double pairs = (double)n * (n - 1) / 2.0;
+    double denom = std::sqrt((pairs - tiesX) * (pairs - tiesY));
+    return denom > 0.0 ? (concordant - discordant) / denom : 0.0;
+  }
+
+  static double spearman(const std::vector<double> &x,
+                         const std::vector<double> &y) {
+    std::vector<double> rx = ranks(x), ry = ranks(y);
+    size_t n = rx.size();
+    if (n < 2)
+      return 0.0;
+    double mean = (n + 1) / 2.0; // Same for both rankings
+    double sxy = 0.0, sxx = 0.0, syy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      sxy += (rx[i] - mean) * (ry[i] - mean);
+      sxx += (rx[i] - mean) * (rx[i] - mean);
+      syy += (ry[i] - mean) * (ry[i] - mean);
+    }
+    return sxx > 0.0 && syy > 0.0 ? sxy / std::sqrt(sxx * syy) : 0.0;
+  }
+
+  // steps^COUNT vectors over the ranges (steps >= 2)
+  static std::vector<ScoringWeights> grid(int steps) {
+    steps = std::max(2, steps);
+    std::vector<ScoringWeights> out;
+    std::vector<int> idx(ScoringWeights::COUNT, 0);
+    while (true) {
+      ScoringWeights w;
+      for (int i = 0; i < ScoringWeights::COUNT; ++i) {
+        float lo, hi;
+        range(i, lo, hi);
+        w[i] = lo + (hi - lo) * idx[i] / (steps - 1);
+      }
+      out.push_back(w);
+      int i = 0;
+      while (i < ScoringWeights::COUNT && ++idx[i] == steps)
+        idx[i++] = 0;
+      if (i == ScoringWeights::COUNT)
+        return out;
+    }
+  }
+
+  static std::vector<ScoringWeights> random(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<ScoringWeights> out;
+    for (int n = 0; n < count; ++n) {
+      ScoringWeights w;
+      for (int i = 0; i < ScoringWeights::COUNT; ++i) {
+        float lo, hi;
+        range(i, lo, hi);
+        w[i] = std::uniform_real_distribution<float>(lo, hi)(rng);
+      }
+      out.push_back(w);
+    }
+    return out;
+  }
+
+  void addRace(ScoringRace race) { races.push_back(std::move(race)); }
+  const std::vector<ScoringRace> &getRaces() const { return races; }
+
+  size_t getInputCount() const {
+    size_t n = 0;
+    for (const ScoringRace &r : races)
+      n += r.inputs.size();
+    return n;
+  }
+
+  SweepResult evaluate(const ScoringWeights &w) const {
+    SweepResult result;
+    result.weights = w;
+    int counted = 0;
+    std::vector<double> predicted, actual;
+    for (const ScoringRace &race : races) {
+      size_t drivers = race.driverIds.size();
+      if (drivers < 2)
+        continue;
+      predicted.assign(drivers, 0.0);
+      actual.resize(drivers);
+      for (size_t d = 0; d < drivers; ++d) {
+        for (uint32_t k = race.inputStart[d]; k < race.inputStart[d + 1]; ++k)
+          predicted[d] += ScoringEngine::calculateScore(
+              race.inputs[k], race.idealLapTime, race.weather,
+              race.trackDifficulty, w);
+        actual[d] = -race.position[d]; // Higher = better, like the score
+      }
+      result.kendall += kendallTauB(predicted, actual);
+      result.spearman += spearman(predicted, actual);
+      counted++;
+    }
+    if (counted > 0) {
+      result.kendall /= counted;
+      result.spearman /= counted;
+    }
+    return result;
+  }
+
+  // Every vector on `threads` workers; results in input order
+  std::vector<SweepResult> run(const std::vector<ScoringWeights> &candidates,
+                               int threads) const {
+    std::vector<SweepResult> results(candidates.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+      size_t i;
+      while ((i = next.fetch_add(1)) < candidates.size())
+        results[i] = evaluate(candidates[i]);
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads && t < (int)candidates.size(); ++t)
+      workers.emplace_back(worker);
+    worker();
+    for (std::thread &t : workers)
+      t.join();
+    return results;
+  }
+
+  // <weights...>,kendall,spearman
+  static bool exportCsv(const std::string &filename,
+                        const std::vector<SweepResult> &results) {
+    FILE *f = std::fopen(filename.c_str(), "w");
+    if (!f)
+      return false;
+    for (int i = 0; i < ScoringWeights::COUNT; ++i)
+      std::fprintf(f, "%s,", ScoringWeights::name(i));
+    std::fprintf(f, "kendall,spearman\n");
+    for (const SweepResult &r : results) {
+      for (int i = 0; i < ScoringWeights::COUNT; ++i)
+        std::fprintf(f, "%g,", r.weights[i]);
+      std::fprintf(f, "%.6f,%.6f\n", r.kendall, r.spearman);
+    }
+    return std::fclose(f) == 0;
+  }
+};
+
+#endif // SCORING_SWEEP_H
@@ -0,0 +1,284 @@
+#ifndef SEASON_EXPORT_H
+#define SEASON_EXPORT_H
+
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+struct DriverResult {
+  std::string name;
+  std::string team;
+  int points;
+  float totalTime;
+  int pitStops;
+  int overtakes;
+  int tyreDegradation;   // Percent of DegradationLimits::wornLoss
+  float degradationRate; // Fitted s/lap of tyre age, last stint
+  float score;
+  int position;
+  std::string status; // "Finished", "DNF", "+1 Lap", etc.
+  float bestLap;      // Timed laps only (missed-lap penalties excluded)
+  float avgLap;
+  float lapStdDev;
+};
+
+struct RaceResult {
+  int raceId;
+  std::string trackName;
+  std::string weather;
+  std::vector<DriverResult> results; // Use std::vector
+  std::string fastestLapDriver;
+  float fastestLapTime;
+  int fastestLap;
+};
+
+// Season standings row, copied out of the Driver objects so it can be
+// serialized while the engine keeps running
+struct StandingRow {
+  std::string name;
+  std::string team;
+  int points;
+  float totalTime;
+};
+
+// dashboard/data.js layout
+template <typename Races>
+void writeSeasonJs(std::ostream &file, const Races &races,
+                   const std::vector<StandingRow> &standings) {
+  file << "window.raceData = {\n";
+
+  // 1. Export History (Custom Vector Iteration)
+  file << "  \"races\": [\n";
+  for (size_t i = 0; i < races.size(); ++i) {
+    const RaceResult &race = *races[i];
+    file << "    {\n";
+    file << "      \"raceId\": " << race.raceId << ",\n";
+    file << "      \"trackName\": \"" << race.trackName << "\",\n";
+    file << "      \"weather\": \"" << race.weather << "\",\n";
+    file << "      \"fastestLap\": {\"name\": \"" << race.fastestLapDriver
+         << "\", \"time\": " << race.fastestLapTime
+         << ", \"lap\": " << race.fastestLap << "},\n";
+    file << "      \"results\": [\n";
+
+    for (size_t j = 0; j < race.results.size(); ++j) {
+      const auto &res = race.results[j];
+      file << "        {"
+           << "\"position\": " << res.position << ", "
+           << "\"name\": \"" << res.name << "\", "
+           << "\"team\": \"" << res.team << "\", "
+           << "\"points\": " << res.points << ", "
+           << "\"time\": "
+           << (std::isnan(res.totalTime) ? 0.0f : res.totalTime) << ", "
+           << "\"overtakes\": " << res.overtakes << ", "
+           << "\"tyreDegradation\": " << res.tyreDegradation << ", "
+           << "\"degradationRate\": " << res.degradationRate << ", "
+           << "\"pits\": " << res.pitStops << ", "
+           << "\"bestLap\": " << res.bestLap << ", "
+           << "\"avgLap\": " << res.avgLap << ", "
+           << "\"lapStdDev\": " << res.lapStdDev << ", "
+           << "\"status\": \"" << res.status << "\"}";
+      if (j < race.results.size() - 1)
+        file << ",";
+      file << "\n";
+    }
+    file << "      ]\n";
+    file << "    }";
+    if (i < races.size() - 1)
+      file << ",";
+    file << "\n";
+  }
+  file << "  ],\n";
+
+  // 2. Export Standings
+  file << "  \"standings\": [\n";
+  for (size_t k = 0; k < standings.size(); ++k) {
+    const StandingRow &d = standings[k];
+    file << "    {"
+         << "\"rank\": " << (k + 1) << ", "
+         << "\"name\": \"" << d.name << "\", "
+         << "\"team\": \"" << d.team << "\", "
+         << "\"points\": " << d.points << ", "
+         << "\"totalTime\": " << (std::isnan(d.totalTime) ? 0.0f : d.totalTime)
+         << "}";
+    if (k < standings.size() - 1)
+      file << ",";
+    file << "\n";
+  }
+  file << "  ]\n";
+
+  file << "};\n";
+}
+
+// Background writer for data.js. endRace hands each finished race over as an
+// immutable snapshot; the producer only appends to the back buffer under a
+// short lock, and the writer thread swaps it with its front buffer and
+// serializes without holding the lock. Races that finish while a write is in
+// progress are coalesced into the next write.
+//
+// Files are written to "<file>.tmp" and renamed over the target, so readers
+// never see a partial export. flush(true) also fsyncs before the rename.
+class ResultExporter {
+private:
+  typedef std::shared_ptr<const RaceResult> ResultPtr;
+
+  std::string filename;
+
+  std::mutex mtx;
+  std::condition_variable wake;
+  std::condition_variable idle;
+
+  // Back buffer (producer side, guarded by mtx)
+  std::vector<ResultPtr> pending;
+  std::vector<StandingRow> latestStandings;
+  bool replaceAll;                 // pending replaces every written race
+  bool durableRequested;
+  uint64_t requested;              // Bumped by every submit/flush
+  uint64_t completed;              // Last request covered by a write
+  bool stopping;
+  bool lastWriteOk;
+
+  // Front buffer (writer thread only)
+  std::vector<ResultPtr> written;
+
+  std::thread worker;
+
+  static bool syncFile(FILE *f) {
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+  }
+
+  bool writeFile(const std::vector<StandingRow> &standings, bool durable) {
+    std::ostringstream out;
+    writeSeasonJs(out, written, standings);
+    const std::string data = out.str();
+
+    const std::string tmp = filename + ".tmp";
+    FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f)
+      return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fflush(f) == 0 && ok;
+    if (durable)
+      ok = syncFile(f) && ok;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok)
+      return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, filename, ec);
+    return !ec;
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      wake.wait(lock, [&] { return stopping || requested != completed; });
+      if (requested == completed)
+        break; // Stopping and nothing left to write
+
+      std::vector<ResultPtr> batch;
+      batch.swap(pending);
+      bool replace = replaceAll;
+      bool durable = durableRequested;
+      std::vector<StandingRow> standings = latestStandings;
+      uint64_t ticket = requested;
+      replaceAll = false;
+      durableRequested = false;
+      lock.unlock();
+
+      if (replace)
+        written.clear();
+      written.insert(written.end(), batch.begin(), batch.end());
+      bool ok = writeFile(standings, durable);
+
+      lock.lock();
+      completed = ticket;
+      lastWriteOk = ok;
+      idle.notify_all();
+    }
+  }
+
+public:
+  explicit ResultExporter(const std::string &file)
+      : filename(file), replaceAll(false), durableRequested(false),
+        requested(0), completed(0), stopping(false), lastWriteOk(true) {
+    worker = std::thread(&ResultExporter::run, this);
+  }
+
+  // Writes anything still pending (without fsync) before returning
+  ~ResultExporter() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+  }
+
+  ResultExporter(const ResultExporter &) = delete;
+  ResultExporter &operator=(const ResultExporter &) = delete;
+
+  // Hands one finished race to the writer. Never waits for I/O.
+  void submit(const RaceResult &result, std::vector<StandingRow> standings) {
+    ResultPtr snapshot = std::make_shared<const RaceResult>(result);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      pending.push_back(std::move(snapshot));
+      latestStandings.swap(standings);
+      requested++;
+    }
+    wake.notify_one();
+  }
+
+  // Replaces the whole exported history (e.g. after restoring a snapshot)
+  void reset(const std::vector<RaceResult> &races,
+             std::vector<StandingRow> standings) {
+    std::vector<ResultPtr> snapshots;
+    for (const RaceResult &r : races)
+      snapshots.push_back(std::make_shared<const RaceResult>(r));
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      pending.swap(snapshots);
+      replaceAll = true;
+      latestStandings.swap(standings);
+      requested++;
+    }
+    wake.notify_one();
+  }
+
+  // Blocks until everything submitted so far is on disk. With `durable` the
+  // file is rewritten and fsynced. Returns false if the last write failed.
+  bool flush(bool durable) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (durable) {
+      durableRequested = true;
+      requested++;
+      wake.notify_one();
+    }
+    uint64_t ticket = requested;
+    idle.wait(lock, [&] { return completed >= ticket; });
+    return lastWriteOk;
+  }
+
+  const std::string &getFilename() const { return filename; }
+};
+
+#endif // SEASON_EXPORT_H
@@ -1,50 +1,46 @@
 #ifndef SEASON_MANAGER_H
 #define SEASON_MANAGER_H
 
+#include "BattleMatrix.h"
+#include "CumulativeTimeIndex.h"
 #include "DriverRegistry.h"
+#include "EventParser.h"
+#include "EventQuery.h"
 #include "HashMap.h"
+#include "LapAnomaly.h"
+#include "LapDelta.h"
+#include "LapTelemetry.h"
+#include "LeaderboardSnapshot.h"
+#include "Logger.h"
 #include "MaxHeap.h"
+#include "MemoryAccounting.h"
+#include "PaceStats.h"
+#include "ParallelLoader.h"
+#include "RaceEventIndex.h"
+#include "ResultCorrection.h"
+#include "SampleTelemetry.h"
 
 #include "ScoringEngine.h"
+#include "ScoringSweep.h"
+#include "SeasonExport.h"
+#include "Snapshot.h"
+#include "TyreDegradation.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
-struct Event {
-  std::string type;   // LAP, PIT, POS, OVERTAKE
-  float value;        // Time or Position
-  std::string detail; // Extra info (e.g., Tyre Compound Name)
-};
-
-struct DriverResult {
-  std::string name;
-  std::string team;
-  int points;
-  float totalTime;
-  int pitStops;
-  int overtakes;
-  int tyreDegradation;
-  float score;
-  int position;
-  std::string status; // "Finished", "DNF", "+1 Lap", etc.
-};
-
-struct RaceResult {
-  int raceId;
-  std::string trackName;
-  std::string weather;
-  std::vector<DriverResult> results; // Use std::vector
-};
-
 class SeasonManager {
 private:
   DriverRegistry *registry;
   MaxHeap *leaderboard;
+  ResultExporter *exporter; // Background data.js writer, nullptr = off
 
   int currentRaceIndex;
   int totalRaces;
@@ -69,6 +65,506 @@ private:
   std::vector<RaceResult> seasonHistory; // Use std::vector
   HashMap<std::string, float> idealTimes;
 
+  // RaceID -> Incremental pace statistics (rebuilt by startRace)
+  std::vector<PaceTracker> racePace;
+  int paceWindow;
+
+  PaceTracker &paceFor(int raceId) {
+    if (raceId >= (int)racePace.size()) {
+      racePace.resize(raceId + 1, PaceTracker(paceWindow));
+    }
+    return racePace[raceId];
+  }
+
+  // RaceID -> Neutralized laps and slow outliers (rebuilt by startRace).
+  // Always detected; only excluded from pace and scoring statistics while
+  // neutralizedLapFiltering is on.
+  std::vector<LapAnomalyDetector> raceAnomalies;
+  AnomalyLimits anomalyLimits;
+  bool neutralizedLapFiltering;
+
+  LapAnomalyDetector &anomaliesFor(int raceId) {
+    if (raceId >= (int)raceAnomalies.size()) {
+      raceAnomalies.resize(raceId + 1);
+    }
+    return raceAnomalies[raceId];
+  }
+
+  // One lap's events per driver, in registration order (nullptr = none).
+  // Gathered once per lap by processRaceLap, or from the transposed streams
+  // by runRaceBatch.
+  typedef std::vector<const std::vector<Event> *> LapEventRow;
+
+  // Feeds the lap's LAP events to the detector before any driver is
+  // applied, so the lap's verdict is known to applyDriverLap
+  void detectLapAnomalies(int raceId, int lap, const LapEventRow &row) {
+    LapAnomalyDetector &detector = anomaliesFor(raceId);
+    const std::vector<Driver *> &drivers = registry->getDrivers();
+    for (size_t i = 0; i < row.size(); ++i) {
+      if (!row[i])
+        continue;
+      for (const auto &ev : *row[i]) {
+        if (ev.type == "LAP")
+          detector.record(lap, drivers[i]->getId(), ev.value);
+      }
+    }
+    detector.finalizeLap(lap);
+  }
+
+  // False for laps left out of pace and scoring statistics
+  bool lapCountsForStats(int raceId, int lap,
+                         const std::string &driverId) const {
+    if (!neutralizedLapFiltering || raceId >= (int)raceAnomalies.size())
+      return true;
+    const LapAnomalyDetector &detector = raceAnomalies[raceId];
+    return !detector.isNeutralized(lap) && !detector.isOutlier(lap, driverId);
+  }
+
+  // RaceID -> Tyre degradation fits per stint and compound (rebuilt by
+  // startRace)
+  std::vector<TyreDegradationModel> raceTyres;
+  DegradationLimits degradationLimits;
+
+  TyreDegradationModel &tyresFor(int raceId) {
+    if (raceId >= (int)raceTyres.size()) {
+      raceTyres.resize(raceId + 1);
+    }
+    return raceTyres[raceId];
+  }
+
+  // Feeds the lap's PIT, COMPOUND and LAP events to the tyre model. Runs
+  // after detectLapAnomalies: neutralized and outlier laps are not fitted.
+  void fitTyres(int raceId, int lap, const LapEventRow &row) {
+    TyreDegradationModel &tyres = tyresFor(raceId);
+    const LapAnomalyDetector &detector = anomaliesFor(raceId);
+    bool neutralized = detector.isNeutralized(lap);
+    const std::vector<Driver *> &drivers = registry->getDrivers();
+    for (size_t i = 0; i < row.size(); ++i) {
+      if (!row[i])
+        continue;
+      const std::string &id = drivers[i]->getId();
+      for (const auto &ev : *row[i]) {
+        if (ev.type == "PIT")
+          tyres.beginStint(id, lap); // Before this lap's time
+      }
+      for (const auto &ev : *row[i]) {
+        if (ev.type == "COMPOUND")
+          tyres.setCompound(id, lap, ev.detail);
+        else if (ev.type == "LAP")
+          tyres.recordLap(id, lap, ev.value,
+                          !neutralized && !detector.isOutlier(lap, id));
+      }
+    }
+    tyres.finalizeLap(lap);
+  }
+
+  // RaceID -> Elapsed time prefix sums (gap / interval queries)
+  std::vector<CumulativeTimeIndex> raceTimeIndex;
+
+  CumulativeTimeIndex &timeIndexFor(int raceId) {
+    if (raceId >= (int)raceTimeIndex.size()) {
+      raceTimeIndex.resize(raceId + 1);
+    }
+    return raceTimeIndex[raceId];
+  }
+
+  // RaceID -> Lap-by-lap samples (binary dashboard export)
+  std::vector<LapTelemetry> raceTelemetry;
+
+  LapTelemetry &telemetryFor(int raceId) {
+    if (raceId >= (int)raceTelemetry.size()) {
+      raceTelemetry.resize(raceId + 1);
+    }
+    return raceTelemetry[raceId];
+  }
+
+  // RaceID -> High-frequency car samples (bounded per driver, see
+  // SampleTelemetry.h). Kept across startRace: the feed may run ahead.
+  std::vector<SampleTelemetry> raceSamples;
+  SampleLimits sampleLimits;
+
+  SampleTelemetry &samplesFor(int raceId) {
+    while (raceId >= (int)raceSamples.size()) {
+      raceSamples.emplace_back(sampleLimits);
+    }
+    return raceSamples[raceId];
+  }
+
+  // Lap containing race time `t` for this driver (first lap whose elapsed
+  // time reaches t), -1 before lap data exists
+  int lapAtTime(int raceId, const std::string &driverId, float t) const {
+    if (raceId < 0 || raceId >= (int)raceTelemetry.size())
+      return -1;
+    const std::vector<LapSample> *row =
+        raceTelemetry[raceId].seriesFor(driverId);
+    if (!row || row->empty())
+      return -1;
+    auto it = std::lower_bound(
+        row->begin(), row->end(), t,
+        [](const LapSample &s, float time) { return s.elapsed < time; });
+    return it == row->end() ? row->back().lap + 1 : it->lap;
+  }
+
+  // RaceID -> Head-to-head matrix, plus the season total (opt-in: O(N^2)
+  // per lap)
+  bool battleTracking;
+  std::vector<BattleMatrix> raceBattles;
+  BattleMatrix seasonBattles;
+
+  BattleMatrix &battlesFor(int raceId) {
+    if (raceId >= (int)raceBattles.size()) {
+      raceBattles.resize(raceId + 1);
+    }
+    return raceBattles[raceId];
+  }
+
+  void updateBattles(int raceId, int lap) {
+    std::vector<std::string> order;
+    std::vector<float> elapsed;
+    for (Driver *d : leaderboard->getOrdered()) {
+      if (d->didParticipate()) {
+        order.push_back(d->getId());
+        elapsed.push_back(d->getRaceTotalTime());
+      }
+    }
+    battlesFor(raceId).update(lap, order, elapsed);
+  }
+
+  // Bitmap column indexes over the loaded events (ad-hoc queries). Built
+  // after every full load; other changes to raceEvents mark it stale and
+  // the next query rebuilds it.
+  EventQueryIndex queryIndex;
+  bool queryIndexStale = true;
+
+  // Lazy loading: byte-offset index over the tape; races are parsed on first
+  // access (startRace) instead of all at once
+  RaceEventIndex eventIndex;
+  std::string indexedTape;     // Empty when events were loaded eagerly
+  std::vector<bool> raceLoaded; // RaceID -> Parsed from indexedTape
+
+  // Live ingestion: events for the live race are buffered per lap and a lap
+  // is only processed once the watermark (highest lap seen - watermarkLag)
+  // passes it. Late events for processed laps rewind to the nearest
+  // checkpoint and recompute from there.
+  struct LapCheckpoint {
+    int lap; // State after this lap (-1 = before the first lap)
+    std::vector<std::pair<DriverHandle, Driver>> drivers;
+    std::vector<DriverHandle> heapOrder;
+    PaceTracker::State pace;
+    TyreDegradationModel::State tyres;
+  };
+
+  int liveRaceId;        // -1 when no live race is open
+  int liveProcessedLap;  // Last lap run through processRaceLap
+  int liveMaxLap;        // Highest lap seen in the feed
+  int liveDirtyLap;      // Earliest processed lap with a late event, -1 none
+  int watermarkLag;
+  int checkpointInterval;
+  int liveRecomputedLaps; // Laps re-run because of late events
+  std::vector<LapCheckpoint> liveCheckpoints; // Ascending by lap
+
+  // Memory budget (bytes, 0 = unlimited). Once exceeded after a race,
+  // finished races' raw events are evicted oldest first; results stay.
+  size_t memoryBudget;
+  std::vector<bool> raceEvicted; // RaceID -> Raw events dropped
+
+  MemoryAccounting::Usage raceEventsUsage(int raceId) const {
+    using namespace MemoryAccounting;
+    Usage u;
+    const auto &laps = raceEvents[raceId];
+    u.add(vectorHeap(laps));
+    for (const auto &lapMap : laps) {
+      u.add(lapMap.footprint());
+      lapMap.forEach(
+          [&](const std::string &id, const std::vector<Event> &events) {
+            u.add(stringHeap(id) + vectorHeap(events), events.size());
+            for (const Event &ev : events)
+              u.add(stringHeap(ev.type) + stringHeap(ev.detail));
+          });
+    }
+    return u;
+  }
+
+  MemoryAccounting::Usage pitStopsUsage(int raceId) const {
+    using namespace MemoryAccounting;
+    Usage u;
+    const auto &stops = pitStops[raceId];
+    u.add(stops.footprint());
+    stops.forEach([&](const std::string &id, const std::vector<int> &laps) {
+      u.add(stringHeap(id) + vectorHeap(laps), laps.size());
+    });
+    return u;
+  }
+
+  // Drops the raw events of every finished race, oldest first, until the
+  // accounted total is back under the budget
+  void enforceMemoryBudget() {
+    if (memoryBudget == 0)
+      return;
+    size_t total = memoryReport().totalBytes();
+    for (const RaceResult &r : seasonHistory) {
+      if (total <= memoryBudget)
+        break;
+      int raceId = r.raceId;
+      if (raceId >= (int)raceEvents.size() || raceEvents[raceId].empty())
+        continue;
+      size_t freed = raceEventsUsage(raceId).bytes;
+      if (raceId < (int)pitStops.size())
+        freed += pitStopsUsage(raceId).bytes;
+      evictRaceEvents(raceId);
+      total = total > freed ? total - freed : 0;
+      Log::info() << "Memory budget: evicted raw events of race " << raceId
+                  << " (" << freed << " bytes)";
+    }
+  }
+
+  // Immutable per-lap classification for reader threads (opt-in)
+  bool leaderboardPublishing;
+  LeaderboardPublisher leaderboardPublisher;
+
+  // `ordered` = classification, P1 first (non-participants are skipped)
+  void publishLeaderboard(int raceId, int lap, bool final,
+                          const std::vector<Driver *> &ordered) {
+    LeaderboardSnapshot snap;
+    snap.raceId = raceId;
+    snap.lap = lap;
+    snap.final = final;
+    snap.rows.reserve(ordered.size());
+    for (Driver *d : ordered) {
+      if (!d->didParticipate())
+        continue;
+      float leaderTime =
+          snap.rows.empty() ? d->getRaceTotalTime() : snap.rows[0].raceTime;
+      snap.rows.push_back({(int)snap.rows.size() + 1, d->getId(), d->getName(),
+                           d->getTeam(), d->getRankingScore(),
+                           d->getRaceTotalTime(),
+                           d->getRaceTotalTime() - leaderTime, d->getPitStops(),
+                           d->getTyreCompound()});
+    }
+    leaderboardPublisher.publish(std::move(snap));
+  }
+
+  // Per-lap change stream. Only computed while someone is subscribed.
+  std::vector<std::function<void(const LapDelta &)>> deltaSubscribers;
+  std::vector<std::function<void(const RaceResult &)>> resultSubscribers;
+  std::vector<std::function<void(const RaceResult &)>> correctionSubscribers;
+  std::vector<ResultCorrection> appliedCorrections;
+  DeltaTracker deltaTracker;
+
+  void publishDelta(const LapDelta &d) {
+    for (auto &sub : deltaSubscribers)
+      sub(d);
+  }
+
+  // Diffs this lap against the previous one. `bestBefore` is the field
+  // fastest lap as it stood before the lap was finalized.
+  void emitLapDeltas(int raceId, int lap, float bestBefore, int bestLapBefore) {
+    std::vector<std::string> order;
+    for (Driver *d : leaderboard->getOrdered()) {
+      if (d->didParticipate())
+        order.push_back(d->getId());
+    }
+    deltaTracker.diffLap(raceId, lap, order,
+                         [&](const LapDelta &d) { publishDelta(d); });
+
+    PaceTracker &pace = paceFor(raceId);
+    if (pace.hasFieldBest() && (bestLapBefore < 0 ||
+                                pace.getFieldBest() < bestBefore)) {
+      publishDelta(LapDelta{raceId, lap, DeltaType::FastestLap,
+                            pace.getFieldBestDriver(), "", 0, 0,
+                            pace.getFieldBest()});
+    }
+
+    const auto &lapEvents = raceEvents[raceId][lap];
+    const auto *prevEvents = lap > 0 ? &raceEvents[raceId][lap - 1] : nullptr;
+    registry->forEach([&](Driver *d) {
+      const std::vector<Event> *events = lapEvents.find(d->getId());
+      if (events) {
+        for (const auto &ev : *events) {
+          if (ev.type == "PIT")
+            publishDelta(LapDelta{raceId, lap, DeltaType::PitIn, d->getId(),
+                                  "", 0, 0, ev.value});
+        }
+        const std::vector<Event> *prev =
+            prevEvents ? prevEvents->find(d->getId()) : nullptr;
+        if (prev) {
+          for (const auto &ev : *prev) {
+            if (ev.type == "PIT")
+              publishDelta(LapDelta{raceId, lap, DeltaType::PitOut,
+                                    d->getId(), "", 0, 0, 0.0f});
+          }
+        }
+      } else if (d->getConsecutiveMissedLaps() == 4) {
+        // First lap past the missed-laps limit
+        publishDelta(
+            LapDelta{raceId, lap, DeltaType::Dnf, d->getId(), "", 0, 0, 0.0f});
+      }
+    });
+  }
+
+  void saveLiveCheckpoint(int lap) {
+    LapCheckpoint cp;
+    cp.lap = lap;
+    registry->forEach([&](Driver *d) {
+      cp.drivers.push_back({registry->getHandle(d->getId()), *d});
+    });
+    for (Driver *d : leaderboard->getUnderlyingContainer()) {
+      cp.heapOrder.push_back(registry->getHandle(d->getId()));
+    }
+    cp.pace = paceFor(liveRaceId).saveState();
+    cp.tyres = tyresFor(liveRaceId).saveState();
+    liveCheckpoints.push_back(cp);
+  }
+
+  // Restores the latest checkpoint taken before `lap`
+  void rewindLiveTo(int lap) {
+    while (liveCheckpoints.size() > 1 && liveCheckpoints.back().lap >= lap) {
+      liveCheckpoints.pop_back();
+    }
+    const LapCheckpoint &cp = liveCheckpoints.back();
+
+    for (const auto &entry : cp.drivers) {
+      Driver *d = registry->getDriver(entry.first);
+      if (d)
+        *d = entry.second; // Drivers removed since then are skipped
+    }
+
+    std::vector<Driver *> heap;
+    for (const auto &h : cp.heapOrder) {
+      Driver *d = registry->getDriver(h);
+      if (d)
+        heap.push_back(d);
+    }
+    // Keep drivers that joined the leaderboard after the checkpoint
+    for (Driver *d : leaderboard->getUnderlyingContainer()) {
+      if (std::find(heap.begin(), heap.end(), d) == heap.end())
+        heap.push_back(d);
+    }
+    leaderboard->assign(heap);
+    leaderboard->rebuild();
+
+    paceFor(liveRaceId).restoreState(cp.pace);
+    timeIndexFor(liveRaceId).truncateAfter(cp.lap);
+    telemetryFor(liveRaceId).truncateAfter(cp.lap);
+    anomaliesFor(liveRaceId).truncateAfter(cp.lap);
+    tyresFor(liveRaceId).restoreState(cp.tyres, cp.lap);
+    if (battleTracking)
+      battlesFor(liveRaceId).truncateAfter(cp.lap);
+    liveProcessedLap = cp.lap;
+  }
+
+  void processLiveLap(int lap) {
+    processRaceLap(liveRaceId, lap);
+    liveProcessedLap = lap;
+    if ((lap + 1) % checkpointInterval == 0) {
+      saveLiveCheckpoint(lap);
+    }
+  }
+
+  // Recomputes dirty laps, then processes every lap up to `sealThrough`
+  void advanceLive(int sealThrough) {
+    if (liveDirtyLap >= 0) {
+      int redoThrough = liveProcessedLap;
+      rewindLiveTo(liveDirtyLap);
+      liveRecomputedLaps += redoThrough - liveProcessedLap;
+      while (liveProcessedLap < redoThrough) {
+        processLiveLap(liveProcessedLap + 1);
+      }
+      liveDirtyLap = -1;
+    }
+    while (liveProcessedLap < sealThrough) {
+      processLiveLap(liveProcessedLap + 1);
+    }
+  }
+
+  // One driver, one lap: applies the driver's events (nullptr = no data this
+  // lap), missed-lap penalties, degradation and the elapsed-time record.
+  // Shared by the lap-major and driver-major paths so both stay identical.
+  void applyDriverLap(Driver *d, int raceId, int lap,
+                      const std::vector<Event> *events, PaceTracker &pace,
+                      CumulativeTimeIndex &timeIndex) {
+    bool processedLap = false;
+    float lapTime = 0.0f;
+    // Check if driver has events in the HashMap
+    if (events) {
+      for (const auto &ev : *events) {
+        if (ev.type == "LAP") {
+          d->updateLapTime(ev.value);
+          lapTime = ev.value;
+          if (lapCountsForStats(raceId, lap, d->getId()))
+            pace.recordLap(d->getId(), lap, ev.value);
+          processedLap = true;
+        } else if (ev.type == "PIT") {
+          d->addPitTime(ev.value);
+          d->resetStint(lap);
+        } else if (ev.type == "POS") {
+          d->setRankingScore(1000.0f - ev.value);
+        } else if (ev.type == "OVERTAKE") {
+          d->recordOvertake();
+        } else if (ev.type == "COMPOUND") {
+          d->setTyreCompound(ev.detail);
+        }
+        d->markParticipated(); // Any event = Participation
+      }
+    }
+
+    if (events) {
+      d->resetMissedLaps(); // Driver is active
+    } else {
+      // Missing Data Scenario
+      // ONLY apply penalties if they have ALREADY participated in this race
+      if (d->didParticipate()) {
+        d->incrementMissedLaps();
+        d->updateLapTime(120.0f); // Reduced penalty (Lapped pace)
+        lapTime = 120.0f;
+
+        // Check if truly DNF (Missed > 3 consecutive laps)
+        if (d->getConsecutiveMissedLaps() > 3) {
+          d->setRankingScore(0.0f); // Confirm DNF
+        }
+      }
+      // If they haven't participated yet, do nothing (they aren't in this
+      // race)
+    }
+
+    // Degradation as fitted after this lap (see fitTyres)
+    if (processedLap) {
+      const TyreEstimate *tyre = tyresFor(raceId).estimateAt(lap, d->getId());
+      d->setDegradationRate(tyre ? tyre->rate : 0.0f);
+      d->setTyreDegradation(tyre ? tyre->degradation : 0.0f);
+    }
+
+    if (d->didParticipate()) {
+      timeIndex.record(d->getId(), lap, d->getRaceTotalTime());
+      float deg = d->getTyreDegradation();
+      telemetryFor(raceId).record(
+          d->getId(),
+          LapSample{lap, lapTime, d->getRaceTotalTime(), 0,
+                    LapTelemetryCodec::compoundCode(d->getTyreCompound()),
+                    (uint8_t)(deg < 0.0f ? 0 : deg > 100.0f ? 100 : deg)});
+    }
+  }
+
+  // Corrections replace the driver's existing LAP/POS/PIT/COMPOUND entry for
+  // that lap; OVERTAKE (a count) and unknown types are appended.
+  void upsertEvent(int raceId, int lap, const std::string &driverId,
+                   const Event &ev) {
+    queryIndexStale = true;
+    if (ev.type != "OVERTAKE" && raceId < (int)raceEvents.size() &&
+        lap < (int)raceEvents[raceId].size()) {
+      std::vector<Event> *events = raceEvents[raceId][lap].find(driverId);
+      if (events) {
+        for (auto &existing : *events) {
+          if (existing.type == ev.type) {
+            existing = ev;
+            return;
+          }
+        }
+      }
+    }
+    storeEvent(raceId, lap, driverId, ev);
+  }
+
 public:
   // Helper for Ideal Lap Time
   void loadIdealLapTimes(const std::string &filename) {
@@ -129,6 +625,19 @@ public:
     return baseTime;
   }
 
+  // Events stored for one lap (all drivers)
+  long long getLapEventCount(int raceId, int lap) const {
+    if (raceId < 0 || raceId >= (int)raceEvents.size() || lap < 0 ||
+        lap >= (int)raceEvents[raceId].size())
+      return 0;
+    long long n = 0;
+    raceEvents[raceId][lap].forEach(
+        [&n](const std::string &, const std::vector<Event> &events) {
+          n += (long long)events.size();
+        });
+    return n;
+  }
+
   // Get Total Laps for a specific race
   int getRaceLapCount(int raceId) {
     // 0-indexed internally, but user passes 1-indexed ID
@@ -157,6 +666,20 @@ public:
     currentRaceIndex = 0;
     totalRaces = 20;
     currentWeather = 0.0f;
+    paceWindow = 5;
+
+    liveRaceId = -1;
+    liveProcessedLap = -1;
+    liveMaxLap = -1;
+    liveDirtyLap = -1;
+    watermarkLag = 1;
+    checkpointInterval = 5;
+    liveRecomputedLaps = 0;
+    memoryBudget = 0;
+    exporter = nullptr;
+    battleTracking = false;
+    leaderboardPublishing = false;
+    neutralizedLapFiltering = false;
 
     trackNames.push_back("Bahrain");
     trackNames.push_back("Saudi Arabia");
@@ -171,6 +694,7 @@ public:
   }
 
   ~SeasonManager() {
+    delete exporter; // Finishes pending writes
     delete registry;
     delete leaderboard;
   }
@@ -178,7 +702,7 @@ public:
   void loadDriversFromFile(const std::string &filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
-      std::cerr << "Failed to open file: " << filename << std::endl;
+      Log::error() << "Failed to open file: " << filename;
       return;
     }
 
@@ -202,12 +726,12 @@ public:
           float speed = std::stof(speedStr);
           registerDriver(id, name, team, speed, pitTime);
         } catch (...) {
-          std::cerr << "Error parsing speed for driver: " << name << std::endl;
+          Log::error() << "Error parsing speed for driver: " << name;
         }
       }
     }
     file.close();
-    std::cout << "Drivers loaded from " << filename << std::endl;
+    Log::info() << "Drivers loaded from " << filename;
   }
 
   void analyzePitStops() {
@@ -241,133 +765,271 @@ public:
       }
     }
 
-    std::cout << "Pit strategies analyzed." << std::endl;
+    Log::info() << "Pit strategies analyzed.";
+  }
+
+  // Applies TRACK/WEATHER metadata from the tape
+  void applyMeta(MetaKind kind, int raceId, const std::string &text,
+                 float value) {
+    if (kind == MetaKind::BatchTrackName) {
+      if (raceId >= (int)trackNames.size()) {
+        trackNames.resize(raceId + 1); // Resize to accommodate raceId
+      }
+      trackNames[raceId] = text;
+    } else if (kind == MetaKind::TrackName) {
+      if (raceId < 1)
+        return;
+      if (raceId > (int)trackNames.size()) {
+        trackNames.resize(raceId);
+      }
+      trackNames[raceId - 1] = text; // Use string value from parsing
+    } else if (kind == MetaKind::Weather) {
+      if (raceId < 0)
+        return;
+      if (raceId >= (int)raceWeathers.size()) {
+        raceWeathers.resize(raceId + 1);
+      }
+      raceWeathers[raceId] = value;
+    }
+  }
+
+  // Parses one line of the event tape. TRACK/WEATHER metadata is applied
+  // directly; every race event is handed to
+  // onEvent(raceId, lap, driverId, const Event &).
+  template <typename Sink>
+  void parseEventLine(const std::string &line, Sink onEvent) {
+    EventParser::parseLine(
+        line, onEvent,
+        [&](MetaKind kind, int raceId, const std::string &text, float value) {
+          applyMeta(kind, raceId, text, value);
+        });
+  }
+
+  // Appends to the RaceID -> Lap -> DriverID store, growing it as needed
+  void storeEvent(int raceId, int lap, const std::string &driverId,
+                  const Event &ev) {
+    // Ensure Vector sizing
+    if (raceId >= (int)raceEvents.size()) {
+      raceEvents.resize(raceId + 1);
+    }
+    if (lap >= (int)raceEvents[raceId].size()) {
+      raceEvents[raceId].resize(lap + 1);
+    }
+
+    if (ev.type == "PIT") {
+      if (raceId >= (int)pitStops.size()) {
+        pitStops.resize(raceId + 1);
+      }
+      pitStops[raceId][driverId].push_back(lap);
+    }
+
+    raceEvents[raceId][lap][driverId].push_back(ev);
   }
 
   void loadRaceEvents(const std::string &filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
-      std::cerr << "Failed to open event file: " << filename << std::endl;
+      Log::error() << "Failed to open event file: " << filename;
       return;
     }
+    indexedTape.clear(); // Everything is resident; no lazy loading
 
     std::string line;
     while (std::getline(file, line)) {
-      std::stringstream ss(line);
-
-      // BATCH MODE
-      if (line.rfind("BATCH,", 0) == 0) {
-        std::string segment;
-        std::vector<std::string> parts;
-        while (std::getline(ss, segment, ',')) {
-          parts.push_back(segment);
-        }
-
-        if (parts.size() < 4)
-          continue;
-
-        try {
-          int raceId = std::stoi(parts[1]);
-          int lap = std::stoi(parts[2]);
-
-          // Check for TRACK,NAME event in batch mode
-          // Format: BATCH,raceId,lap,TRACK:NAME:TrackName
-          if (parts.size() >= 4 && parts[3].rfind("TRACK:NAME:", 0) == 0) {
-            std::string trackNameValue =
-                parts[3].substr(11); // "TRACK:NAME:".length()
-            if (raceId >= (int)trackNames.size()) {
-              trackNames.resize(raceId + 1); // Resize to accommodate raceId
-            }
-            trackNames[raceId] = trackNameValue;
-            continue; // Processed this line, move to next
-          }
-
-          // Dynamically resize raceEvents vector
-          if (raceId >= (int)raceEvents.size()) {
-            raceEvents.resize(raceId + 1);
-          }
-          if (lap >= (int)raceEvents[raceId].size()) {
-            raceEvents[raceId].resize(lap + 1);
-          }
-
-          for (size_t i = 3; i < parts.size(); ++i) {
-            std::string item = parts[i];
-            size_t colonPos = item.find(':');
-            if (colonPos != std::string::npos) {
-              std::string driverId = item.substr(0, colonPos);
-              float time = std::stof(item.substr(colonPos + 1));
-              raceEvents[raceId][lap][driverId].push_back({"LAP", time, ""});
-            }
-          }
-        } catch (...) {
-        }
-
-      } else {
-        // STANDARD MODE
-        std::string raceIdStr, lapStr, driverId, type, valStr;
-        if (std::getline(ss, raceIdStr, ',') && std::getline(ss, lapStr, ',') &&
-            std::getline(ss, driverId, ',') && std::getline(ss, type, ',') &&
-            std::getline(ss, valStr, ',')) {
+      parseEventLine(line, [&](int raceId, int lap, const std::string &driverId,
+                               const Event &ev) {
+        storeEvent(raceId, lap, driverId, ev);
+      });
+    }
+    file.close();
+    Log::info() << "Race Events loaded from " << filename;
+    analyzePitStops();
+    buildEventQueryIndex();
+  }
 
-          try {
-            int raceId = std::stoi(raceIdStr);
-            int lap = std::stoi(lapStr);
+  // Indexes the tape (reusing "<file>.idx" when up to date) without parsing
+  // any race. Races are then loaded on demand by startRace/ensureRaceLoaded.
+  bool openRaceEvents(const std::string &filename) {
+    bool rebuilt = false;
+    if (!eventIndex.open(filename, rebuilt)) {
+      Log::error() << "Failed to open event file: " << filename;
+      return false;
+    }
+    indexedTape = filename;
+    raceLoaded.clear();
+    Log::info() << "Race Events indexed from " << filename
+                << (rebuilt ? " (index rebuilt)" : " (cached index)");
+    return true;
+  }
 
-            float val = 0.0f;
-            std::string detail = "";
+  // Parses a single race from the indexed tape (no-op if already loaded or
+  // if events were loaded eagerly)
+  bool ensureRaceLoaded(int raceId) {
+    if (indexedTape.empty() || raceId < 0)
+      return true;
+    if (raceId < (int)raceLoaded.size() && raceLoaded[raceId])
+      return true;
+    if (raceId < (int)raceEvents.size() && !raceEvents[raceId].empty())
+      return true; // Already present (eager load or restored snapshot)
+    if (!eventIndex.hasRace(raceId)) {
+      Log::error() << "Race " << raceId << " not found in " << indexedTape;
+      return false;
+    }
 
-            if (type == "COMPOUND" || (driverId == "TRACK" && type == "NAME")) {
-              detail = valStr; // Treat as string
-            } else {
-              val = std::stof(valStr);
-            }
+    if (raceId < (int)pitStops.size())
+      pitStops[raceId].clear(); // Rebuilt by storeEvent
+    bool ok = eventIndex.forEachLine(
+        indexedTape, raceId, [&](const std::string &line) {
+          parseEventLine(line, [&](int id, int lap,
+                                   const std::string &driverId,
+                                   const Event &ev) {
+            storeEvent(id, lap, driverId, ev);
+          });
+        });
+    if (raceId >= (int)raceLoaded.size())
+      raceLoaded.resize(raceId + 1, false);
+    raceLoaded[raceId] = ok;
+    queryIndexStale = true;
+    return ok;
+  }
 
-            if (driverId == "TRACK" && type == "NAME") {
-              if (raceId > (int)trackNames.size()) {
-                trackNames.resize(raceId);
-              }
-              trackNames[raceId - 1] = detail; // Use string value from parsing
-            } else if (type == "WEATHER") {
-              if (raceId >= (int)raceWeathers.size()) {
-                raceWeathers.resize(raceId + 1);
-              }
-              raceWeathers[raceId] = val;
-            } else {
-              // Ensure Vector sizing
-              if (raceId >= (int)raceEvents.size()) {
-                raceEvents.resize(raceId + 1);
-              }
-              if (lap >= (int)raceEvents[raceId].size()) {
-                raceEvents[raceId].resize(lap + 1);
-              }
+  // Same result as loadRaceEvents, parsed on `threads` cores: chunks are
+  // parsed in parallel, then each race is merged (chunk order = file order)
+  // on its own worker. Metadata lines are applied in file order.
+  void loadRaceEventsParallel(const std::string &filename, int threads) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open event file: " << filename;
+      return;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+    file.close();
+    indexedTape.clear(); // Everything is resident; no lazy loading
 
-              if (type == "PIT") {
-                if (raceId >= (int)pitStops.size()) {
-                  pitStops.resize(raceId + 1);
-                }
-                pitStops[raceId][driverId].push_back(lap);
-              }
+    std::vector<ParallelLoader::ChunkBuffer> buffers =
+        ParallelLoader::parse(data, threads);
 
-              raceEvents[raceId][lap][driverId].push_back({type, val, detail});
-            }
-          } catch (...) {
-          }
+    size_t raceCount = raceEvents.size();
+    for (const auto &buf : buffers) {
+      for (const auto &m : buf.meta)
+        applyMeta(m.kind, m.raceId, m.text, m.value);
+      if (buf.byRace.size() > raceCount)
+        raceCount = buf.byRace.size();
+    }
+    // Outer vectors are sized up front so race workers never reallocate them
+    raceEvents.resize(raceCount);
+    if (pitStops.size() < raceCount)
+      pitStops.resize(raceCount);
+
+    std::atomic<int> nextRace(0);
+    auto mergeWorker = [&]() {
+      for (int raceId = nextRace++; raceId < (int)raceCount;
+           raceId = nextRace++) {
+        for (auto &buf : buffers) {
+          if (raceId >= (int)buf.byRace.size())
+            continue;
+          for (auto &pe : buf.byRace[raceId])
+            storeEvent(raceId, pe.lap, pe.driverId, pe.ev);
         }
+        // Lap order, as analyzePitStops would produce
+        pitStops[raceId].forEach([](const std::string &, std::vector<int> &l) {
+          std::stable_sort(l.begin(), l.end());
+        });
       }
-    }
-    file.close();
-    std::cout << "Race Events loaded from " << filename << std::endl;
-    analyzePitStops();
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads && t < (int)raceCount; ++t)
+      workers.emplace_back(mergeWorker);
+    mergeWorker();
+    for (auto &w : workers)
+      w.join();
+
+    Log::info() << "Race Events loaded from " << filename << " (" << threads
+                << " threads)";
+    buildEventQueryIndex();
   }
 
   void registerDriver(std::string id, std::string name, std::string team,
                       float speed, float pitTime) {
     Driver *d = new Driver(id, name, team, speed, pitTime);
-    registry->addDriver(d);
+    if (registry->addDriver(d).isNull()) {
+      Log::error() << "Duplicate driver id: " << id;
+      delete d;
+      return;
+    }
+    leaderboard->push(d);
+  }
+
+  // Drops a driver from the registry and the live leaderboard. Finished race
+  // results in seasonHistory are kept.
+  bool removeDriver(const std::string &id) {
+    Driver *d = registry->getDriver(id);
+    if (!d)
+      return false;
+    leaderboard->remove(d);
+    return registry->removeDriver(id);
+  }
+
+  // Seat change (e.g. reserve driver): the replacement takes the outgoing
+  // driver's place in registration order and starts with zero season points.
+  bool swapDriver(const std::string &outgoingId, std::string id,
+                  std::string name, std::string team, float speed,
+                  float pitTime) {
+    Driver *outgoing = registry->getDriver(outgoingId);
+    if (!outgoing)
+      return false;
+
+    Driver *d = new Driver(id, name, team, speed, pitTime);
+    leaderboard->remove(outgoing);
+    if (registry->replaceDriver(outgoingId, d).isNull()) {
+      leaderboard->push(outgoing);
+      delete d;
+      return false;
+    }
     leaderboard->push(d);
+    return true;
   }
 
   void startRace(int raceId) {
+    ensureRaceLoaded(raceId);
+    currentRaceIndex = raceId - 1; // endRace reports against this race
+
+    // endRace only re-queues that race's participants: bring back drivers
+    // who sat a race out, so the field never depends on earlier rounds
+    const std::vector<Driver *> &drivers = registry->getDrivers();
+    std::vector<char> queued(drivers.size(), 0); // Registration order
+    for (Driver *d : leaderboard->getUnderlyingContainer()) {
+      int i = registry->indexOf(d->getId());
+      if (i >= 0)
+        queued[i] = 1;
+    }
+    for (size_t i = 0; i < drivers.size(); ++i) {
+      if (!queued[i])
+        leaderboard->push(drivers[i]);
+    }
+    paceFor(raceId) = PaceTracker(paceWindow);
+    timeIndexFor(raceId) = CumulativeTimeIndex();
+    telemetryFor(raceId) = LapTelemetry();
+    float weather =
+        raceId < (int)raceWeathers.size() ? raceWeathers[raceId] : 0.0f;
+    anomaliesFor(raceId) = LapAnomalyDetector(
+        anomalyLimits,
+        raceId >= 1 && raceId <= (int)trackNames.size()
+            ? getIdealLapTime(trackNames[raceId - 1], weather)
+            : 0.0f);
+    tyresFor(raceId) =
+        TyreDegradationModel(degradationLimits, getRaceLapCount(raceId));
+    deltaTracker.reset();
+    if (battleTracking) {
+      std::vector<std::string> ids, teams;
+      for (const Driver *d : registry->getDrivers()) {
+        ids.push_back(d->getId());
+        teams.push_back(d->getTeam());
+      }
+      battlesFor(raceId).reset(ids, teams);
+    }
+
     if (raceId < (int)raceEvents.size() && raceEvents[raceId].size() > 0) {
       auto &gridEvents = raceEvents[raceId][0]; // Lap 0
       gridEvents.forEach(
@@ -375,8 +1037,8 @@ public:
             Driver *d = registry->getDriver(driverId);
             if (d) {
               d->markParticipated();
-              // std::cout << "DEBUG: Initialized " << driverId << " from Grid."
-              // << std::endl;
+              // Log::debug() << "DEBUG: Initialized " << driverId
+              //              << " from Grid.";
             }
           });
     }
@@ -397,82 +1059,277 @@ public:
 
     // Access via reference
     auto &lapEvents = raceEvents[raceId][lap];
+    PaceTracker &pace = paceFor(raceId);
+    CumulativeTimeIndex &timeIndex = timeIndexFor(raceId);
+
+    float bestBefore = pace.getFieldBest();
+    int bestLapBefore = pace.getFieldBestLap();
+    const std::vector<Driver *> &drivers = registry->getDrivers();
+    LapEventRow row(drivers.size());
+    for (size_t i = 0; i < drivers.size(); ++i)
+      row[i] = lapEvents.find(drivers[i]->getId());
+    detectLapAnomalies(raceId, lap, row);
+    fitTyres(raceId, lap, row);
+
+    // Registration order, as in the row
+    for (size_t i = 0; i < drivers.size(); ++i)
+      applyDriverLap(drivers[i], raceId, lap, row[i], pace, timeIndex);
+
+    pace.finalizeLap(lap);
+    timeIndex.finalizeLap(lap);
+    leaderboard->rebuild();
 
-    // Registry forEach
-    registry->forEach([&](Driver *d) {
-      bool processedLap = false;
-      // Check if driver has events in the HashMap
-      if (lapEvents.contains(d->getId())) {
-        std::vector<Event> &events = lapEvents[d->getId()];
-        for (const auto &ev : events) {
-          if (ev.type == "LAP") {
-            d->updateLapTime(ev.value);
-            processedLap = true;
-          } else if (ev.type == "PIT") {
-            d->addPitTime(ev.value);
-            d->resetStint(lap);
-          } else if (ev.type == "POS") {
-            d->setRankingScore(1000.0f - ev.value);
-          } else if (ev.type == "OVERTAKE") {
-            d->recordOvertake();
-          } else if (ev.type == "COMPOUND") {
-            d->setTyreCompound(ev.detail);
-          }
-          d->markParticipated(); // Any event = Participation
-        }
-      }
+    if (!deltaSubscribers.empty())
+      emitLapDeltas(raceId, lap, bestBefore, bestLapBefore);
+    if (battleTracking && lap > 0) // Lap 0 is the grid: no gaps yet
+      updateBattles(raceId, lap);
+    if (leaderboardPublishing)
+      publishLeaderboard(raceId, lap, false, leaderboard->getOrdered());
+  }
 
-      if (lapEvents.contains(d->getId())) {
-        d->resetMissedLaps(); // Driver is active
-      } else {
-        // Missing Data Scenario
-        // ONLY apply penalties if they have ALREADY participated in this race
-        if (d->didParticipate()) {
-          d->incrementMissedLaps();
-          d->updateLapTime(120.0f); // Reduced penalty (Lapped pace)
-
-          // Check if truly DNF (Missed > 3 consecutive laps)
-          if (d->getConsecutiveMissedLaps() > 3) {
-            d->setRankingScore(0.0f); // Confirm DNF
-          }
-        }
-        // If they haven't participated yet, do nothing (they aren't in this
-        // race)
+  // Receives every change record produced by processRaceLap. Laps
+  // recomputed after late live events are re-emitted. runRaceBatch does not
+  // produce per-lap deltas.
+  void subscribeDeltas(std::function<void(const LapDelta &)> callback) {
+    deltaSubscribers.push_back(callback);
+  }
+
+  // Receives every finished race right after endRace() records it
+  void subscribeResults(std::function<void(const RaceResult &)> callback) {
+    resultSubscribers.push_back(callback);
+  }
+
+  // Receives the corrected race after every applyCorrection()
+  void subscribeCorrections(std::function<void(const RaceResult &)> callback) {
+    correctionSubscribers.push_back(callback);
+  }
+
+  // Applies a stewards' decision to a race that has already ended. Only
+  // that race is reclassified, from its stored results (see
+  // reclassifyRace); season points and time change by the per-driver
+  // difference. Returns false if the race or driver is not classified.
+  bool applyCorrection(const ResultCorrection &c) {
+    RaceResult *race = nullptr;
+    for (RaceResult &r : seasonHistory) {
+      if (r.raceId == c.raceId)
+        race = &r;
+    }
+    Driver *penalized = registry->getDriver(c.driverId);
+    if (!race || !penalized) {
+      Log::error() << "Correction " << c.describe() << " for " << c.driverId
+                   << " ignored: race " << c.raceId << " or driver not found";
+      return false;
+    }
+
+    std::vector<DriverResult> before = race->results;
+    std::string error;
+    if (!reclassifyRace(*race, penalized->getName(), c, error)) {
+      Log::error() << "Correction ignored: " << error;
+      return false;
+    }
+
+    HashMap<std::string, Driver *> byName(64);
+    registry->forEach([&](Driver *d) { byName.put(d->getName(), d); });
+    Log::info() << "Race " << c.raceId << " corrected: " << penalized->getName()
+                << " " << c.describe();
+    for (const DriverResult &old : before) {
+      const DriverResult *now = nullptr;
+      for (const DriverResult &r : race->results) {
+        if (r.name == old.name)
+          now = &r;
       }
+      Driver *const *d = byName.find(old.name);
+      if (!now || !d)
+        continue;
+      (*d)->addSeasonPoints(now->points - old.points);
+      (*d)->addSeasonTime(now->totalTime - old.totalTime);
+      if (now->position != old.position)
+        Log::info() << "  " << old.name << ": P" << old.position << " -> P"
+                    << now->position << " (" << old.points << " -> "
+                    << now->points << " pts)";
+    }
 
-      // Calculate Degradation
-      if (processedLap) {
-        int nextPitLap = getRaceLapCount(raceId); // Dynamic end of race
+    appliedCorrections.push_back(c);
+    for (auto &sub : correctionSubscribers)
+      sub(*race);
+    if (exporter)
+      exporter->reset(seasonHistory, standingsSnapshot());
+    return true;
+  }
 
-        // Check if pitStops has info for this race/driver
-        if (raceId < (int)pitStops.size() &&
-            pitStops[raceId].contains(d->getId())) {
-          std::vector<int> &stops = pitStops[raceId][d->getId()];
-          for (const int stopLap : stops) {
-            if (stopLap > lap) {
-              nextPitLap = stopLap;
-              break;
-            }
-          }
-        }
+  // Decisions applied since startup (not stored in snapshots: their effect
+  // on results and points is)
+  const std::vector<ResultCorrection> &getAppliedCorrections() const {
+    return appliedCorrections;
+  }
 
-        int lapsInStint = nextPitLap - d->getStintStartLap();
-        if (lapsInStint <= 0)
-          lapsInStint = 1;
+  // Driver-major evaluation for offline reprocessing (replaces startRace +
+  // processRaceLap over every lap). The lap tables are transposed once into
+  // per-driver event streams, each driver's race is evaluated in a single
+  // pass, and the leaderboard is built once at the end. endRace() output is
+  // identical to the lap-major path.
+  void runRaceBatch(int raceId) {
+    startRace(raceId);
+    if (raceId < 0 || raceId >= (int)raceEvents.size())
+      return;
+
+    currentWeather =
+        raceId < (int)raceWeathers.size() ? raceWeathers[raceId] : 0.0f;
 
-        int currentStintLaps = lap - d->getStintStartLap();
+    int lastLap = std::min(getRaceLapCount(raceId),
+                           (int)raceEvents[raceId].size() - 1);
+    const std::vector<Driver *> &drivers = registry->getDrivers();
 
-        float progress = (float)currentStintLaps / (float)lapsInStint;
-        float deg = progress * 80.0f;
-        if (deg > 100.0f)
-          deg = 100.0f;
-        d->setTyreDegradation(deg);
+    HashMap<std::string, int> streamOf(128);
+    for (size_t i = 0; i < drivers.size(); ++i)
+      streamOf.put(drivers[i]->getId(), (int)i);
+
+    // DriverIndex -> (Lap, Events) in lap order
+    std::vector<std::vector<std::pair<int, const std::vector<Event> *>>>
+        streams(drivers.size());
+    for (int lap = 0; lap <= lastLap; ++lap) {
+      raceEvents[raceId][lap].forEach(
+          [&](const std::string &driverId, std::vector<Event> &events) {
+            const int *idx = streamOf.find(driverId);
+            if (idx)
+              streams[*idx].push_back({lap, &events});
+          });
+    }
+
+    // Whole field, lap by lap, before any driver: the row is read off the
+    // streams' heads, so no lap table is searched again
+    std::vector<size_t> head(drivers.size(), 0);
+    LapEventRow row(drivers.size());
+    for (int lap = 0; lap <= lastLap; ++lap) {
+      for (size_t i = 0; i < drivers.size(); ++i) {
+        const auto &stream = streams[i];
+        row[i] = nullptr;
+        if (head[i] < stream.size() && stream[head[i]].first == lap)
+          row[i] = stream[head[i]++].second;
       }
-    });
+      detectLapAnomalies(raceId, lap, row);
+      fitTyres(raceId, lap, row);
+    }
 
+    PaceTracker &pace = paceFor(raceId);
+    CumulativeTimeIndex &timeIndex = timeIndexFor(raceId);
+    for (size_t i = 0; i < drivers.size(); ++i) {
+      const auto &stream = streams[i];
+      size_t next = 0;
+      for (int lap = 0; lap <= lastLap; ++lap) {
+        const std::vector<Event> *events = nullptr;
+        if (next < stream.size() && stream[next].first == lap)
+          events = stream[next++].second;
+        applyDriverLap(drivers[i], raceId, lap, events, pace, timeIndex);
+      }
+    }
+
+    pace.finalizePending();
+    for (int lap = 0; lap <= lastLap; ++lap)
+      timeIndex.finalizeLap(lap);
     leaderboard->rebuild();
+    if (leaderboardPublishing)
+      publishLeaderboard(raceId, lastLap, false, leaderboard->getOrdered());
+  }
+
+  // Runs one race lap-major (startRace ... endRace, so it counts towards
+  // the season) and records what ScoringEngine::calculateScore is given for
+  // every driver with data on each lap, plus the final classification.
+  // Weight sweeps then replay the inputs without touching the events again.
+  ScoringRace recordScoringRace(int raceId) {
+    ScoringRace race;
+    race.raceId = raceId;
+    race.weather =
+        raceId < (int)raceWeathers.size() ? raceWeathers[raceId] : 0.0f;
+    const std::vector<Driver *> &drivers = registry->getDrivers();
+    std::vector<std::vector<ScoringInput>> laps(drivers.size());
+
+    startRace(raceId);
+    for (int lap = 0; lap <= getRaceLapCount(raceId); ++lap) {
+      processRaceLap(raceId, lap);
+      if (lap == 0)
+        continue; // Grid: no lap times yet
+      for (size_t i = 0; i < drivers.size(); ++i) {
+        Driver *d = drivers[i];
+        if (d->didParticipate() && d->getConsecutiveMissedLaps() == 0 &&
+            d->getCurrentLapTime() > 0.0f &&
+            lapCountsForStats(raceId, lap, d->getId()))
+          laps[i].push_back(ScoringInput::from(d));
+      }
+    }
+    endRace();
+
+    const RaceResult &result = seasonHistory.back();
+    race.idealLapTime = getIdealLapTime(result.trackName, race.weather);
+    HashMap<std::string, int> indexOf(64);
+    for (size_t i = 0; i < drivers.size(); ++i)
+      indexOf.put(drivers[i]->getName(), (int)i);
+    for (const DriverResult &r : result.results) {
+      const int *i = indexOf.find(r.name);
+      if (!i)
+        continue;
+      race.driverIds.push_back(drivers[*i]->getId());
+      race.position.push_back(r.position);
+      race.inputStart.push_back((uint32_t)race.inputs.size());
+      race.inputs.insert(race.inputs.end(), laps[*i].begin(), laps[*i].end());
+    }
+    race.inputStart.push_back((uint32_t)race.inputs.size());
+    return race;
+  }
+
+  // Opens a race for live ingestion (replaces startRace for streamed feeds)
+  void beginLiveRace(int raceId) {
+    startRace(raceId);
+    liveRaceId = raceId;
+    liveProcessedLap = -1;
+    liveMaxLap = -1;
+    liveDirtyLap = -1;
+    liveRecomputedLaps = 0;
+    liveCheckpoints.clear();
+    saveLiveCheckpoint(-1);
   }
 
+  // Feeds one event of the live race. Events may arrive out of order: laps
+  // behind the watermark are processed, and a late event for an already
+  // processed lap triggers recomputation from the nearest checkpoint only.
+  bool ingestEvent(int raceId, int lap, const std::string &driverId,
+                   const Event &ev) {
+    if (raceId != liveRaceId || lap < 0) {
+      Log::error() << "Event for race " << raceId
+                   << " ignored: not the live race";
+      return false;
+    }
+
+    upsertEvent(raceId, lap, driverId, ev);
+    if (lap <= liveProcessedLap && (liveDirtyLap < 0 || lap < liveDirtyLap)) {
+      liveDirtyLap = lap;
+    }
+    if (lap > liveMaxLap) {
+      liveMaxLap = lap;
+    }
+
+    advanceLive(liveMaxLap - watermarkLag);
+    return true;
+  }
+
+  // Seals every buffered lap of the live race. Call before endRace().
+  void finishLiveRace() {
+    if (liveRaceId < 0)
+      return;
+    advanceLive(liveMaxLap);
+    liveRaceId = -1;
+    liveCheckpoints.clear();
+  }
+
+  // Laps a lap stays open for late events before it is processed
+  void setWatermarkLag(int laps) { watermarkLag = laps > 0 ? laps : 0; }
+  // Laps between saved rewind points (memory vs. recompute trade-off)
+  void setCheckpointInterval(int laps) {
+    checkpointInterval = laps > 0 ? laps : 1;
+  }
+  int getLiveProcessedLap() const { return liveProcessedLap; }
+  int getLiveRecomputedLaps() const { return liveRecomputedLaps; }
+
   void endRace() {
     std::vector<Driver *> raceResults;
     while (!leaderboard->isEmpty()) {
@@ -486,6 +1343,12 @@ public:
       }
     }
 
+    // Classification: score, ties broken by driver id (heap pop order is
+    // not defined for equal scores)
+    std::stable_sort(raceResults.begin(), raceResults.end(), classifiedAhead);
+    if (leaderboardPublishing) // Before the race state is reset below
+      publishLeaderboard(currentRaceIndex + 1, -1, true, raceResults);
+
     // New Safety Reset for ALL drivers in registry
     // This ensures that even drivers NOT in the leaderboard (dropped) are
     // reset.
@@ -496,13 +1359,11 @@ public:
       }
     });
 
-    int points[] = {25, 18, 15, 12, 10, 8, 6, 4, 2, 1};
-
     std::string trackName = (currentRaceIndex < (int)trackNames.size())
                                 ? trackNames[currentRaceIndex]
                                 : "Unknown Track";
-    std::cout << "\n--- Race " << (currentRaceIndex + 1) << " Results ["
-              << trackName << "] ---" << std::endl;
+    Log::info() << "\n--- Race " << (currentRaceIndex + 1) << " Results ["
+                << trackName << "] ---";
 
     RaceResult currentResult;
     currentResult.raceId = currentRaceIndex + 1;
@@ -515,28 +1376,46 @@ public:
     }
 
     currentResult.weather = (weatherVal > 0.1f) ? "Rainy" : "Dry";
-    std::cout << "Weather: " << currentResult.weather << std::endl;
+    Log::info() << "Weather: " << currentResult.weather;
+
+    PaceTracker &pace = paceFor(currentResult.raceId);
+    currentResult.fastestLapDriver = "";
+    currentResult.fastestLapTime = 0.0f;
+    currentResult.fastestLap = 0;
+    if (pace.hasFieldBest()) {
+      Driver *fl = registry->getDriver(pace.getFieldBestDriver());
+      currentResult.fastestLapDriver =
+          fl ? fl->getName() : pace.getFieldBestDriver();
+      currentResult.fastestLapTime = pace.getFieldBest();
+      currentResult.fastestLap = pace.getFieldBestLap();
+      Log::info() << "Fastest Lap: " << currentResult.fastestLapDriver << " ("
+                  << currentResult.fastestLapTime << "s, Lap "
+                  << currentResult.fastestLap << ")";
+    }
 
     for (size_t i = 0; i < raceResults.size(); ++i) {
       Driver *d = raceResults[i];
-      int pts = (i < 10) ? points[i] : 0;
+      int pts = racePointsFor(i);
 
       d->addSeasonPoints(pts);
       d->addSeasonTime(d->getRaceTotalTime());
 
-      std::cout << (i + 1) << ". " << d->getName() << " (" << d->getTeam()
-                << ") - " << pts << " pts [Score: " << d->getRankingScore()
-                << "] [Time: " << d->getRaceTotalTime()
-                << "s] [Pits: " << d->getPitStops()
-                << "] [Tyres: " << d->getTyreCompound() << "]" << std::endl;
+      Log::info() << (i + 1) << ". " << d->getName() << " (" << d->getTeam()
+                  << ") - " << pts << " pts [Score: " << d->getRankingScore()
+                  << "] [Time: " << d->getRaceTotalTime()
+                  << "s] [Pits: " << d->getPitStops()
+                  << "] [Tyres: " << d->getTyreCompound() << "]";
 
       std::string status =
           (d->getConsecutiveMissedLaps() > 3) ? "DNF" : "Finished";
 
+      const RollingPaceStats *ps = pace.getStats(d->getId());
       currentResult.results.push_back(
           {d->getName(), d->getTeam(), pts, d->getRaceTotalTime(),
            d->getPitStops(), d->getOvertakes(), (int)d->getTyreDegradation(),
-           d->getRankingScore(), (int)(i + 1), status});
+           d->getDegradationRate(), d->getRankingScore(), (int)(i + 1), status,
+           ps ? ps->getPersonalBest() : 0.0f, ps ? ps->getMean() : 0.0f,
+           ps ? ps->getStdDev() : 0.0f});
 
       d->resetRaceState();
       d->forceUnparticipate();
@@ -544,93 +1423,932 @@ public:
 
     seasonHistory.push_back(currentResult);
 
+    if (battleTracking && currentResult.raceId < (int)raceBattles.size()) {
+      BattleMatrix &battles = raceBattles[currentResult.raceId];
+      battles.dropHistory(); // Only needed for live rewinds
+      seasonBattles.accumulate(battles);
+    }
+
     for (Driver *d : raceResults) {
       leaderboard->push(d);
     }
 
     currentRaceIndex++;
+    for (auto &sub : resultSubscribers)
+      sub(seasonHistory.back());
+    if (exporter)
+      exporter->submit(seasonHistory.back(), standingsSnapshot());
+    enforceMemoryBudget();
   }
 
   std::vector<Driver *> getSeasonStandings() {
     std::vector<Driver *> standings;
     registry->forEach([&](Driver *d) { standings.push_back(d); });
 
-    // We need to sort functionality. Vector doesn't have sort method built-in,
-    // nor does it expose iterators compatible with std::sort if implemented
-    // poorly. However, our Vector has begin()/end() pointers so std::sort
-    // SHOULD work.
-    std::sort(standings.begin(), standings.end(), [](Driver *a, Driver *b) {
+    // Stable so that ties keep registration order
+    std::stable_sort(standings.begin(), standings.end(), [](Driver *a, Driver *b) {
       return a->getSeasonPoints() > b->getSeasonPoints();
     });
 
     return standings;
   }
 
+  // Standings copied out of the drivers (safe to hand to another thread)
+  std::vector<StandingRow> standingsSnapshot() {
+    std::vector<StandingRow> rows;
+    for (Driver *d : getSeasonStandings()) {
+      rows.push_back({d->getName(), d->getTeam(), d->getSeasonPoints(),
+                      d->getSeasonTotalTime()});
+    }
+    return rows;
+  }
+
   void exportSeasonToJson(const std::string &filename) {
     std::ofstream file(filename);
-    file << "window.raceData = {\n";
-
-    // 1. Export History (Custom Vector Iteration)
-    file << "  \"races\": [\n";
-    for (size_t i = 0; i < seasonHistory.size(); ++i) {
-      const auto &race = seasonHistory[i];
-      file << "    {\n";
-      file << "      \"raceId\": " << race.raceId << ",\n";
-      file << "      \"trackName\": \"" << race.trackName << "\",\n";
-      file << "      \"weather\": \"" << race.weather << "\",\n";
-      file << "      \"results\": [\n";
-
-      for (size_t j = 0; j < race.results.size(); ++j) {
-        const auto &res = race.results[j];
-        file << "        {"
-             << "\"position\": " << res.position << ", "
-             << "\"name\": \"" << res.name << "\", "
-             << "\"team\": \"" << res.team << "\", "
-             << "\"points\": " << res.points << ", "
-             << "\"time\": "
-             << (std::isnan(res.totalTime) ? 0.0f : res.totalTime) << ", "
-             << "\"overtakes\": " << res.overtakes << ", "
-             << "\"tyreDegradation\": " << res.tyreDegradation << ", "
-             << "\"pits\": " << res.pitStops << ", "
-             << "\"status\": \"" << res.status << "\"}";
-        if (j < race.results.size() - 1)
-          file << ",";
+    std::vector<const RaceResult *> races;
+    for (const RaceResult &r : seasonHistory)
+      races.push_back(&r);
+    writeSeasonJs(file, races, standingsSnapshot());
+    file.close();
+    Log::info() << "Data exported to " << filename;
+  }
+
+  // From now on every finished race is exported to `filename` in the
+  // background (see ResultExporter); call flushExport() at durability points
+  void enableAsyncExport(const std::string &filename) {
+    delete exporter;
+    exporter = new ResultExporter(filename);
+    if (!seasonHistory.empty())
+      exporter->reset(seasonHistory, standingsSnapshot());
+  }
+
+  // Waits for the background export; `durable` also fsyncs the file
+  bool flushExport(bool durable) {
+    if (!exporter)
+      return false;
+    bool ok = exporter->flush(durable);
+    if (ok) {
+      Log::info() << "Data exported to " << exporter->getFilename();
+    } else {
+      Log::error() << "Failed to write export file: "
+                   << exporter->getFilename();
+    }
+    return ok;
+  }
+
+  // Per-lap pace statistics for every processed race (one row per timed lap)
+  void exportPaceStatsCsv(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open pace export file: " << filename;
+      return;
+    }
+    file << "RaceId,Lap,Driver,LapTime,Mean,StdDev,WindowStdDev,PersonalBest,"
+            "FieldBest,DeltaToPersonalBest,DeltaToFieldBest,DeltaToMean,"
+            "DeltaToPrevious\n";
+    for (size_t raceId = 0; raceId < racePace.size(); ++raceId) {
+      racePace[raceId].forEachHistory(
+          [&](const std::string &driverId, std::vector<PaceSnapshot> &laps) {
+            for (const auto &p : laps) {
+              file << raceId << "," << p.lap << "," << driverId << ","
+                   << p.lapTime << "," << p.mean << "," << p.stdDev << ","
+                   << p.windowStdDev << "," << p.personalBest << ","
+                   << p.fieldBest << "," << p.deltaToPersonalBest << ","
+                   << p.deltaToFieldBest << "," << p.deltaToMean << ","
+                   << p.deltaToPrevious << "\n";
+            }
+          });
+    }
+    file.close();
+    Log::info() << "Pace statistics exported to " << filename;
+  }
+
+  // Writes the full season state (registry, standings, history, events, pit
+  // data, race index) as a checksummed binary snapshot. Take it between races:
+  // in-race driver state and per-race analytics (pace/gap indexes) are not
+  // included. A lazily loaded season only holds the races parsed so far, so
+  // the tape path is stored and reopened by loadSnapshot for the rest.
+  bool saveSnapshot(const std::string &filename) {
+    Snapshot::Writer w;
+
+    w.write<int32_t>(currentRaceIndex);
+    w.write<int32_t>(totalRaces);
+    w.write<int32_t>(paceWindow);
+    w.writeString(indexedTape);
+
+    w.write<uint32_t>((uint32_t)trackNames.size());
+    for (const auto &t : trackNames)
+      w.writeString(t);
+
+    w.write<uint32_t>((uint32_t)raceWeathers.size());
+    for (float wv : raceWeathers)
+      w.write<float>(wv);
+
+    w.write<uint32_t>((uint32_t)idealTimes.getSize());
+    idealTimes.forEach([&](const std::string &track, float &t) {
+      w.writeString(track);
+      w.write<float>(t);
+    });
+
+    // Registry (registration order)
+    w.write<uint32_t>((uint32_t)registry->size());
+    registry->forEach([&](Driver *d) {
+      w.writeString(d->getId());
+      w.writeString(d->getName());
+      w.writeString(d->getTeam());
+      w.write<float>(d->getBaseSpeed());
+      w.write<float>(d->getBasePitTime());
+      w.write<int32_t>(d->getSeasonPoints());
+      w.write<float>(d->getSeasonTotalTime());
+    });
+
+    // Leaderboard membership in heap order (restores identical tie-breaks)
+    const std::vector<Driver *> &heap = leaderboard->getUnderlyingContainer();
+    w.write<uint32_t>((uint32_t)heap.size());
+    for (Driver *d : heap)
+      w.writeString(d->getId());
+
+    w.write<uint32_t>((uint32_t)raceEvents.size());
+    for (auto &race : raceEvents) {
+      w.write<uint32_t>((uint32_t)race.size());
+      for (auto &lap : race) {
+        w.write<uint32_t>((uint32_t)lap.getSize());
+        lap.forEach([&](const std::string &driverId, std::vector<Event> &evs) {
+          w.writeString(driverId);
+          w.write<uint32_t>((uint32_t)evs.size());
+          for (const auto &ev : evs) {
+            w.writeString(ev.type);
+            w.write<float>(ev.value);
+            w.writeString(ev.detail);
+          }
+        });
+      }
+    }
+
+    w.write<uint32_t>((uint32_t)pitStops.size());
+    for (auto &race : pitStops) {
+      w.write<uint32_t>((uint32_t)race.getSize());
+      race.forEach([&](const std::string &driverId, std::vector<int> &laps) {
+        w.writeString(driverId);
+        w.write<uint32_t>((uint32_t)laps.size());
+        for (int l : laps)
+          w.write<int32_t>(l);
+      });
+    }
+
+    w.write<uint32_t>((uint32_t)seasonHistory.size());
+    for (const auto &race : seasonHistory) {
+      w.write<int32_t>(race.raceId);
+      w.writeString(race.trackName);
+      w.writeString(race.weather);
+      w.writeString(race.fastestLapDriver);
+      w.write<float>(race.fastestLapTime);
+      w.write<int32_t>(race.fastestLap);
+      w.write<uint32_t>((uint32_t)race.results.size());
+      for (const auto &r : race.results) {
+        w.writeString(r.name);
+        w.writeString(r.team);
+        w.write<int32_t>(r.points);
+        w.write<float>(r.totalTime);
+        w.write<int32_t>(r.pitStops);
+        w.write<int32_t>(r.overtakes);
+        w.write<int32_t>(r.tyreDegradation);
+        w.write<float>(r.degradationRate);
+        w.write<float>(r.score);
+        w.write<int32_t>(r.position);
+        w.writeString(r.status);
+        w.write<float>(r.bestLap);
+        w.write<float>(r.avgLap);
+        w.write<float>(r.lapStdDev);
+      }
+    }
+
+    const std::vector<char> &payload = w.data();
+    uint64_t payloadSize = payload.size();
+    uint64_t sum = Snapshot::checksum(payload.data(), payload.size());
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open snapshot file: " << filename;
+      return false;
+    }
+    file.write(Snapshot::MAGIC, 4);
+    file.write(reinterpret_cast<const char *>(&Snapshot::VERSION), 4);
+    file.write(reinterpret_cast<const char *>(&Snapshot::BYTE_ORDER_MARK), 4);
+    file.write(reinterpret_cast<const char *>(&payloadSize), 8);
+    file.write(payload.data(), payload.size());
+    file.write(reinterpret_cast<const char *>(&sum), 8);
+    file.flush();
+    if (!file) {
+      Log::error() << "Failed to write snapshot: " << filename;
+      return false;
+    }
+    file.close();
+    Log::info() << "Snapshot saved to " << filename << " (" << payloadSize
+                << " bytes)";
+    return true;
+  }
+
+  // Restores a snapshot written by saveSnapshot. The current state is only
+  // replaced if the whole file validates (header, version, checksum, layout).
+  bool loadSnapshot(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open snapshot file: " << filename;
+      return false;
+    }
+    std::streamsize fileSize = file.tellg();
+    file.seekg(0);
+    std::vector<char> bytes(fileSize > 0 ? (size_t)fileSize : 0);
+    if (fileSize > 0)
+      file.read(bytes.data(), fileSize);
+    file.close();
+
+    const size_t headerSize = 4 + 4 + 4 + 8;
+    if (bytes.size() < headerSize + 8 ||
+        std::memcmp(bytes.data(), Snapshot::MAGIC, 4) != 0) {
+      Log::error() << "Not a RaceLogic snapshot: " << filename;
+      return false;
+    }
+    uint32_t version, bom;
+    uint64_t payloadSize, storedSum;
+    std::memcpy(&version, bytes.data() + 4, 4);
+    std::memcpy(&bom, bytes.data() + 8, 4);
+    std::memcpy(&payloadSize, bytes.data() + 12, 8);
+    if (version != Snapshot::VERSION || bom != Snapshot::BYTE_ORDER_MARK) {
+      Log::error() << "Unsupported snapshot version/byte order: " << filename;
+      return false;
+    }
+    if (payloadSize != bytes.size() - headerSize - 8) {
+      Log::error() << "Truncated snapshot: " << filename;
+      return false;
+    }
+    const char *payload = bytes.data() + headerSize;
+    std::memcpy(&storedSum, payload + payloadSize, 8);
+    if (Snapshot::checksum(payload, payloadSize) != storedSum) {
+      Log::error() << "Snapshot checksum mismatch: " << filename;
+      return false;
+    }
+
+    Snapshot::Reader r(payload, payloadSize);
+
+    int newRaceIndex = r.read<int32_t>();
+    int newTotalRaces = r.read<int32_t>();
+    int newPaceWindow = r.read<int32_t>();
+    std::string newTape = r.readString();
+
+    uint32_t count = r.read<uint32_t>();
+    std::vector<std::string> newTrackNames;
+    if (r.canHold(count, 4)) {
+      for (uint32_t i = 0; i < count; ++i)
+        newTrackNames.push_back(r.readString());
+    }
+
+    count = r.read<uint32_t>();
+    std::vector<float> newWeathers;
+    if (r.canHold(count, 4)) {
+      for (uint32_t i = 0; i < count; ++i)
+        newWeathers.push_back(r.read<float>());
+    }
+
+    HashMap<std::string, float> newIdealTimes;
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 8)) {
+      for (uint32_t i = 0; i < count; ++i) {
+        std::string track = r.readString();
+        newIdealTimes.put(track, r.read<float>());
+      }
+    }
+
+    DriverRegistry *newRegistry = new DriverRegistry();
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 28)) {
+      for (uint32_t i = 0; i < count && r.ok(); ++i) {
+        std::string id = r.readString();
+        std::string name = r.readString();
+        std::string team = r.readString();
+        float speed = r.read<float>();
+        float pitTime = r.read<float>();
+        int pts = r.read<int32_t>();
+        float seasonTime = r.read<float>();
+        Driver *d = new Driver(id, name, team, speed, pitTime);
+        d->restoreSeasonState(pts, seasonTime);
+        if (newRegistry->addDriver(d).isNull()) {
+          delete d; // Duplicate id: corrupt snapshot
+          r.fail();
+        }
+      }
+    }
+
+    MaxHeap *newLeaderboard = new MaxHeap();
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 4)) {
+      for (uint32_t i = 0; i < count && r.ok(); ++i) {
+        Driver *d = newRegistry->getDriver(r.readString());
+        if (d)
+          newLeaderboard->push(d);
+        else
+          r.fail();
+      }
+    }
+
+    std::vector<std::vector<HashMap<std::string, std::vector<Event>>>>
+        newEvents;
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 4)) {
+      newEvents.resize(count);
+      for (auto &race : newEvents) {
+        uint32_t laps = r.read<uint32_t>();
+        if (!r.canHold(laps, 4))
+          break;
+        race.resize(laps);
+        for (auto &lap : race) {
+          uint32_t drivers = r.read<uint32_t>();
+          if (!r.canHold(drivers, 8))
+            break;
+          for (uint32_t i = 0; i < drivers; ++i) {
+            std::vector<Event> &evs = lap[r.readString()];
+            uint32_t n = r.read<uint32_t>();
+            if (!r.canHold(n, 12))
+              break;
+            evs.reserve(n);
+            for (uint32_t k = 0; k < n; ++k) {
+              Event ev;
+              ev.type = r.readString();
+              ev.value = r.read<float>();
+              ev.detail = r.readString();
+              evs.push_back(ev);
+            }
+          }
+        }
+      }
+    }
+
+    std::vector<HashMap<std::string, std::vector<int>>> newPitStops;
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 4)) {
+      newPitStops.resize(count);
+      for (auto &race : newPitStops) {
+        uint32_t drivers = r.read<uint32_t>();
+        if (!r.canHold(drivers, 8))
+          break;
+        for (uint32_t i = 0; i < drivers; ++i) {
+          std::vector<int> &laps = race[r.readString()];
+          uint32_t n = r.read<uint32_t>();
+          if (!r.canHold(n, 4))
+            break;
+          for (uint32_t k = 0; k < n; ++k)
+            laps.push_back(r.read<int32_t>());
+        }
+      }
+    }
+
+    std::vector<RaceResult> newHistory;
+    count = r.read<uint32_t>();
+    if (r.canHold(count, 28)) {
+      newHistory.resize(count);
+      for (auto &race : newHistory) {
+        race.raceId = r.read<int32_t>();
+        race.trackName = r.readString();
+        race.weather = r.readString();
+        race.fastestLapDriver = r.readString();
+        race.fastestLapTime = r.read<float>();
+        race.fastestLap = r.read<int32_t>();
+        uint32_t n = r.read<uint32_t>();
+        if (!r.canHold(n, 56))
+          break;
+        race.results.resize(n);
+        for (auto &res : race.results) {
+          res.name = r.readString();
+          res.team = r.readString();
+          res.points = r.read<int32_t>();
+          res.totalTime = r.read<float>();
+          res.pitStops = r.read<int32_t>();
+          res.overtakes = r.read<int32_t>();
+          res.tyreDegradation = r.read<int32_t>();
+          res.degradationRate = r.read<float>();
+          res.score = r.read<float>();
+          res.position = r.read<int32_t>();
+          res.status = r.readString();
+          res.bestLap = r.read<float>();
+          res.avgLap = r.read<float>();
+          res.lapStdDev = r.read<float>();
+        }
+      }
+    }
+
+    if (!r.ok() || !r.atEnd()) {
+      Log::error() << "Malformed snapshot payload: " << filename;
+      delete newLeaderboard;
+      delete newRegistry;
+      return false;
+    }
+
+    // Races not yet parsed when the snapshot was taken come from the tape
+    if (!newTape.empty()) {
+      bool rebuilt = false;
+      if (!eventIndex.open(newTape, rebuilt)) {
+        Log::error() << "Snapshot " << filename << " needs event file "
+                     << newTape << ", which cannot be opened";
+        delete newLeaderboard;
+        delete newRegistry;
+        return false;
+      }
+    }
+
+    // Commit
+    delete leaderboard;
+    delete registry;
+    registry = newRegistry;
+    leaderboard = newLeaderboard;
+    currentRaceIndex = newRaceIndex;
+    totalRaces = newTotalRaces;
+    paceWindow = newPaceWindow > 0 ? newPaceWindow : 1;
+    trackNames = std::move(newTrackNames);
+    raceWeathers = std::move(newWeathers);
+    idealTimes = newIdealTimes;
+    raceEvents = std::move(newEvents);
+    pitStops = std::move(newPitStops);
+    seasonHistory = std::move(newHistory);
+    indexedTape = newTape;
+    raceLoaded.clear(); // Restored races count as present (ensureRaceLoaded)
+    raceEvicted.clear();
+    if (exporter)
+      exporter->reset(seasonHistory, standingsSnapshot());
+    racePace.clear();
+    raceTimeIndex.clear();
+    raceTelemetry.clear();
+    raceBattles.clear();
+    seasonBattles = BattleMatrix();
+    raceAnomalies.clear();
+    raceTyres.clear();
+    raceSamples.clear();
+    queryIndexStale = true;
+
+    Log::info() << "Snapshot restored from " << filename << " (race index "
+                << currentRaceIndex << ")";
+    return true;
+  }
+
+  // Elapsed time, position, gap to leader and interval per lap (for charting)
+  void exportGapsCsv(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open gap export file: " << filename;
+      return;
+    }
+    file << "RaceId,Lap,Position,Driver,ElapsedTime,GapToLeader,Interval\n";
+    for (size_t raceId = 0; raceId < raceTimeIndex.size(); ++raceId) {
+      raceTimeIndex[raceId].forEachEntry(
+          [&](int lap, int position, const std::string &driverId,
+              float elapsed, float gap, float interval) {
+            file << raceId << "," << lap << "," << position << ","
+                 << driverId << "," << elapsed << "," << gap << ","
+                 << interval << "\n";
+          });
+    }
+    file.close();
+    Log::info() << "Gap data exported to " << filename;
+  }
+
+  // Lap-by-lap telemetry of every race run so far as a compact columnar
+  // binary (see LapTelemetry.h), written base64-wrapped into a script so the
+  // dashboard can load it without a server. Returns the binary size.
+  size_t exportLapTelemetryJs(const std::string &filename) {
+    std::vector<int> races;
+    for (size_t raceId = 0; raceId < raceTelemetry.size(); ++raceId) {
+      bool any = false;
+      raceTelemetry[raceId].forEachDriver(
+          [&](const std::string &, std::vector<LapSample> &row) {
+            any = any || !row.empty();
+          });
+      if (any)
+        races.push_back((int)raceId);
+    }
+
+    std::string bytes;
+    LapTelemetryCodec::beginFile(bytes, races.size());
+    for (int raceId : races) {
+      std::vector<std::pair<std::string, std::vector<LapSample> *>> drivers;
+      raceTelemetry[raceId].forEachDriver(
+          [&](const std::string &id, std::vector<LapSample> &row) {
+            if (!row.empty())
+              drivers.push_back({id, &row});
+          });
+      LapTelemetryCodec::beginRace(bytes, raceId, drivers.size());
+      const CumulativeTimeIndex &timeIndex = timeIndexFor(raceId);
+      for (auto &entry : drivers) {
+        for (LapSample &sample : *entry.second)
+          sample.position = timeIndex.getPosition(entry.first, sample.lap);
+        LapTelemetryCodec::putDriver(bytes, entry.first, *entry.second);
+      }
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open lap telemetry file: " << filename;
+      return 0;
+    }
+    file << "window.lapTelemetry = \"" << LapTelemetryCodec::base64(bytes)
+         << "\";\n";
+    file.close();
+    Log::info() << "Lap telemetry exported to " << filename << " ("
+                << bytes.size() << " bytes)";
+    return bytes.size();
+  }
+
+  // Bytes and object counts per structure; race-scoped stores are reported
+  // per race (raceId -1 = season-wide)
+  MemoryAccounting::Report memoryReport() const {
+    using namespace MemoryAccounting;
+    Report report;
+    for (size_t raceId = 0; raceId < raceEvents.size(); ++raceId) {
+      if (!raceEvents[raceId].empty())
+        report.add("raceEvents", (int)raceId, raceEventsUsage((int)raceId));
+    }
+    for (size_t raceId = 0; raceId < pitStops.size(); ++raceId) {
+      if (pitStops[raceId].getSize() > 0)
+        report.add("pitStops", (int)raceId, pitStopsUsage((int)raceId));
+    }
+    for (size_t raceId = 0; raceId < racePace.size(); ++raceId)
+      report.add("paceStats", (int)raceId, racePace[raceId].memoryUsage());
+    for (size_t raceId = 0; raceId < raceTimeIndex.size(); ++raceId)
+      report.add("gapIndex", (int)raceId, raceTimeIndex[raceId].memoryUsage());
+    for (size_t raceId = 0; raceId < raceTelemetry.size(); ++raceId)
+      report.add("lapTelemetry", (int)raceId,
+                 raceTelemetry[raceId].memoryUsage());
+    for (size_t raceId = 0; raceId < raceTyres.size(); ++raceId) {
+      if (!raceTyres[raceId].getStints().empty())
+        report.add("tyreModel", (int)raceId, raceTyres[raceId].memoryUsage());
+    }
+    for (size_t raceId = 0; raceId < raceAnomalies.size(); ++raceId) {
+      if (!raceAnomalies[raceId].getLaps().empty())
+        report.add("lapAnomalies", (int)raceId,
+                   raceAnomalies[raceId].memoryUsage());
+    }
+    if (queryIndex.getRowCount() > 0)
+      report.add("eventQuery", -1, queryIndex.memoryUsage());
+    for (size_t raceId = 0; raceId < raceBattles.size(); ++raceId) {
+      if (raceBattles[raceId].size() > 0)
+        report.add("battles", (int)raceId, raceBattles[raceId].memoryUsage());
+    }
+    if (seasonBattles.size() > 0)
+      report.add("battles", -1, seasonBattles.memoryUsage());
+    for (size_t raceId = 0; raceId < raceSamples.size(); ++raceId) {
+      if (raceSamples[raceId].getTotalSamples() > 0)
+        report.add("samples", (int)raceId, raceSamples[raceId].memoryUsage());
+    }
+
+    Usage history;
+    history.add(vectorHeap(seasonHistory));
+    for (const RaceResult &r : seasonHistory) {
+      history.add(stringHeap(r.trackName) + stringHeap(r.weather) +
+                      stringHeap(r.fastestLapDriver) + vectorHeap(r.results),
+                  1 + r.results.size());
+      for (const DriverResult &dr : r.results)
+        history.add(stringHeap(dr.name) + stringHeap(dr.team) +
+                    stringHeap(dr.status));
+    }
+    report.add("seasonHistory", -1, history);
+
+    Usage drivers;
+    for (const Driver *d : registry->getDrivers()) {
+      drivers.add(sizeof(Driver) + stringHeap(d->getId()) +
+                      stringHeap(d->getName()) + stringHeap(d->getTeam()) +
+                      stringHeap(d->getTyreCompound()),
+                  1);
+    }
+    drivers.add(leaderboard->getUnderlyingContainer().capacity() *
+                sizeof(Driver *));
+    report.add("drivers", -1, drivers);
+
+    Usage ideal;
+    ideal.add(idealTimes.footprint(), idealTimes.getSize());
+    report.add("idealTimes", -1, ideal);
+    return report;
+  }
+
+  // Frees a race's raw events and pit table. Results, pace statistics and
+  // the gap index are kept. With an indexed tape the race can be re-read on
+  // demand.
+  void evictRaceEvents(int raceId) {
+    if (raceId < 0)
+      return;
+    if (raceId < (int)raceEvents.size())
+      std::vector<HashMap<std::string, std::vector<Event>>>().swap(
+          raceEvents[raceId]);
+    if (raceId < (int)pitStops.size())
+      pitStops[raceId].clear();
+    if (raceId < (int)raceLoaded.size())
+      raceLoaded[raceId] = false;
+    if (raceId >= (int)raceEvicted.size())
+      raceEvicted.resize(raceId + 1, false);
+    raceEvicted[raceId] = true;
+    queryIndexStale = true;
+  }
+
+  bool isRaceEvicted(int raceId) const {
+    return raceId >= 0 && raceId < (int)raceEvicted.size() &&
+           raceEvicted[raceId];
+  }
+
+  // 0 disables eviction
+  void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+  // Publishes an immutable leaderboard snapshot after every processed lap,
+  // runRaceBatch and endRace (see LeaderboardSnapshot.h)
+  void setLeaderboardPublishing(bool enabled) {
+    leaderboardPublishing = enabled;
+  }
+
+  // Safe from any thread, without pausing the engine. Empty (null) until
+  // the first snapshot is published.
+  LeaderboardPublisher::Reader readLeaderboard() const {
+    return leaderboardPublisher.read();
+  }
+  LeaderboardSnapshot getLeaderboardSnapshot() const {
+    return leaderboardPublisher.copy();
+  }
+
+  // Leaves neutralized laps (safety car, VSC, red flag) and each driver's
+  // slow outlier laps out of pace statistics and recorded scoring inputs.
+  // Detection itself always runs (see LapAnomaly.h).
+  void setNeutralizedLapFiltering(bool enabled) {
+    neutralizedLapFiltering = enabled;
+  }
+
+  // Applies to races started afterwards
+  void setAnomalyLimits(const AnomalyLimits &limits) {
+    anomalyLimits = limits;
+  }
+
+  // nullptr if the race never ran
+  const LapAnomalyDetector *getLapAnomalies(int raceId) const {
+    if (raceId < 0 || raceId >= (int)raceAnomalies.size() ||
+        raceAnomalies[raceId].getLaps().empty())
+      return nullptr;
+    return &raceAnomalies[raceId];
+  }
+
+  // One row per lap with lap times:
+  //   RaceId,Lap,Drivers,Median,MAD,Reference,Neutralized,Outliers
+  // Outliers = "DRIVER:time" separated by ';'
+  void exportLapAnomaliesCsv(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open anomaly export file: " << filename;
+      return;
+    }
+    file << "RaceId,Lap,Drivers,Median,MAD,Reference,Neutralized,Outliers\n";
+    for (size_t raceId = 0; raceId < raceAnomalies.size(); ++raceId) {
+      for (const LapAnomaly &a : raceAnomalies[raceId].getLaps()) {
+        if (a.drivers == 0)
+          continue;
+        file << raceId << "," << a.lap << "," << a.drivers << "," << a.median
+             << "," << a.mad << "," << a.reference << ","
+             << (a.neutralized ? 1 : 0) << ",";
+        for (size_t i = 0; i < a.outliers.size(); ++i)
+          file << (i ? ";" : "") << a.outliers[i].first << ":"
+               << a.outliers[i].second;
         file << "\n";
       }
-      file << "      ]\n";
-      file << "    }";
-      if (i < seasonHistory.size() - 1)
-        file << ",";
-      file << "\n";
-    }
-    file << "  ],\n";
-
-    // 2. Export Standings
-    file << "  \"standings\": [\n";
-    auto standings = getSeasonStandings();
-    for (size_t k = 0; k < standings.size(); ++k) {
-      Driver *d = standings[k];
-      file << "    {"
-           << "\"rank\": " << (k + 1) << ", "
-           << "\"name\": \"" << d->getName() << "\", "
-           << "\"team\": \"" << d->getTeam() << "\", "
-           << "\"points\": " << d->getSeasonPoints() << ", "
-           << "\"totalTime\": "
-           << (std::isnan(d->getSeasonTotalTime()) ? 0.0f
-                                                   : d->getSeasonTotalTime())
-           << "}";
-      if (k < standings.size() - 1)
-        file << ",";
-      file << "\n";
-    }
-    file << "  ]\n";
-
-    file << "};\n";
+    }
     file.close();
-    std::cout << "Data exported to " << filename << std::endl;
+    if (!file) {
+      Log::error() << "Failed to write anomaly export file: " << filename;
+      return;
+    }
+    Log::info() << "Lap anomalies exported to " << filename;
+  }
+
+  // Applies to races started afterwards
+  void setDegradationLimits(const DegradationLimits &limits) {
+    degradationLimits = limits;
+  }
+
+  // nullptr if the race never ran
+  const TyreDegradationModel *getTyreModel(int raceId) const {
+    if (raceId < 0 || raceId >= (int)raceTyres.size() ||
+        raceTyres[raceId].getStints().empty())
+      return nullptr;
+    return &raceTyres[raceId];
+  }
+
+  // One row per stint and one per compound (Driver and StartLap empty):
+  //   RaceId,Track,Driver,Compound,StartLap,Laps,Rate,FreshPace
+  // Rate = fitted s/lap of tyre age, FreshPace = fuel-corrected lap time at
+  // age 0 (stints only). Laps = fitted samples.
+  void exportDegradationCsv(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open degradation export file: " << filename;
+      return;
+    }
+    file << "RaceId,Track,Driver,Compound,StartLap,Laps,Rate,FreshPace\n";
+    for (size_t raceId = 0; raceId < raceTyres.size(); ++raceId) {
+      const TyreDegradationModel &m = raceTyres[raceId];
+      std::string track = raceId >= 1 && raceId <= trackNames.size()
+                              ? trackNames[raceId - 1]
+                              : "";
+      for (const TyreStint &s : m.getStints()) {
+        if (s.fit.n == 0)
+          continue;
+        file << raceId << "," << track << "," << s.driverId << ","
+             << s.compound << "," << s.startLap << "," << s.fit.n << ","
+             << s.fit.slope() << "," << s.fit.intercept() << "\n";
+      }
+      for (const CompoundFit &c : m.getCompounds())
+        file << raceId << "," << track << ",," << c.compound << ",,"
+             << c.laps << "," << c.slope() << ",\n";
+    }
+    Log::info() << "Tyre degradation exported to " << filename;
+  }
+
+  // Head-to-head matrices are only built while enabled (before startRace)
+  void setBattleTracking(bool enabled) { battleTracking = enabled; }
+
+  // nullptr if the race was not tracked
+  const BattleMatrix *getRaceBattles(int raceId) const {
+    if (raceId < 0 || raceId >= (int)raceBattles.size() ||
+        raceBattles[raceId].size() == 0)
+      return nullptr;
+    return &raceBattles[raceId];
+  }
+
+  const BattleMatrix &getSeasonBattles() const { return seasonBattles; }
+
+  // One row per pair that shared the track (RaceId 0 = season total):
+  //   RaceId,DriverA,DriverB,Teammates,LapsAhead,LapsBehind,LapsTogether,
+  //   MinGap,OvertakesGained,OvertakesLost
+  void exportBattlesCsv(const std::string &filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open battle export file: " << filename;
+      return;
+    }
+    file << "RaceId,DriverA,DriverB,Teammates,LapsAhead,LapsBehind,"
+            "LapsTogether,MinGap,OvertakesGained,OvertakesLost\n";
+    auto writeMatrix = [&](int raceId, const BattleMatrix &m) {
+      m.forEachPair([&](int a, int b, const BattleRecord &r) {
+        file << raceId << "," << m.getId(a) << "," << m.getId(b) << ","
+             << (m.getTeam(a) == m.getTeam(b) ? 1 : 0) << "," << r.lapsAhead
+             << "," << r.lapsBehind << "," << r.lapsTogether << ","
+             << r.minGap << "," << r.overtakesGained << ","
+             << r.overtakesLost << "\n";
+      });
+    };
+    writeMatrix(0, seasonBattles);
+    for (size_t raceId = 0; raceId < raceBattles.size(); ++raceId)
+      writeMatrix((int)raceId, raceBattles[raceId]);
+    file.close();
+    Log::info() << "Battle matrix exported to " << filename;
+  }
+
+  // Rebuilds the bitmap indexes over every resident race
+  void buildEventQueryIndex() {
+    queryIndex.build(raceEvents, [this](int raceId) {
+      return raceId < (int)raceWeathers.size() ? raceWeathers[raceId] : 0.0f;
+    });
+    queryIndexStale = false;
+  }
+
+  // Row ids of the matching events (see EventQuery for the filters). Races
+  // that are not resident (lazy or evicted) are not searched.
+  RoaringBitmap queryEvents(const EventQuery &query) {
+    if (queryIndexStale)
+      buildEventQueryIndex();
+    return queryIndex.select(query);
+  }
+
+  const EventQueryIndex &getEventQueryIndex() {
+    if (queryIndexStale)
+      buildEventQueryIndex();
+    return queryIndex;
+  }
+
+  // Applies to races whose sample store is created afterwards
+  void setSampleLimits(const SampleLimits &limits) { sampleLimits = limits; }
+
+  // One high-frequency sample from the car feed
+  void ingestSample(int raceId, const std::string &driverId,
+                    const TelemetrySample &sample) {
+    if (raceId < 0)
+      return;
+    samplesFor(raceId).ingest(driverId, sample);
+  }
+
+  // race,driver,t,speed,x,y per line. Returns the number of samples read,
+  // or -1 if the file cannot be opened.
+  long long loadTelemetrySamples(const std::string &filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open sample file: " << filename;
+      return -1;
+    }
+    long long loaded = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+      std::stringstream ss(line);
+      std::string race, driverId, t, speed, x, y;
+      if (!std::getline(ss, race, ',') || !std::getline(ss, driverId, ',') ||
+          !std::getline(ss, t, ',') || !std::getline(ss, speed, ','))
+        continue;
+      std::getline(ss, x, ',');
+      std::getline(ss, y, ',');
+      try {
+        TelemetrySample sample{std::stof(t), std::stof(speed),
+                               x.empty() ? 0.0f : std::stof(x),
+                               y.empty() ? 0.0f : std::stof(y)};
+        ingestSample(std::stoi(race), driverId, sample);
+        loaded++;
+      } catch (...) {
+        // Header or malformed line
+      }
+    }
+    return loaded;
+  }
+
+  const SampleTelemetry *getSamples(int raceId) const {
+    if (raceId < 0 || raceId >= (int)raceSamples.size())
+      return nullptr;
+    return &raceSamples[raceId];
+  }
+
+  // Speed min/max/mean over one lap, joined through the lap elapsed times
+  // (bucket resolution). count == 0 when there is nothing to report.
+  SampleBucket getLapSampleStats(int raceId, const std::string &driverId,
+                                 int lap) const {
+    SampleBucket none{0, 0.0f, 0.0f, 0.0, 0, TelemetrySample{0, 0, 0, 0}};
+    const SampleTelemetry *samples = getSamples(raceId);
+    const DriverSampleChannel *ch = samples ? samples->channel(driverId) : nullptr;
+    if (!ch || raceId >= (int)raceTelemetry.size())
+      return none;
+    const std::vector<LapSample> *row =
+        raceTelemetry[raceId].seriesFor(driverId);
+    if (!row)
+      return none;
+    float from = 0.0f;
+    for (const LapSample &s : *row) {
+      if (s.lap == lap)
+        return ch->aggregate(from, s.elapsed);
+      from = s.elapsed;
+    }
+    return none;
+  }
+
+  // LTTB-downsampled speed trace per driver (over the bucket means), each
+  // point joined with the lap it falls in:
+  //   RaceId,Driver,Time,Lap,Speed,MinSpeed,MaxSpeed,X,Y
+  void exportSamplesCsv(const std::string &filename, size_t pointsPerDriver) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+      Log::error() << "Failed to open sample export file: " << filename;
+      return;
+    }
+    file << "RaceId,Driver,Time,Lap,Speed,MinSpeed,MaxSpeed,X,Y\n";
+    for (size_t raceId = 0; raceId < raceSamples.size(); ++raceId) {
+      raceSamples[raceId].forEachDriver([&](const std::string &driverId,
+                                            const DriverSampleChannel &ch) {
+        const std::vector<SampleBucket> &buckets = ch.getBuckets();
+        std::vector<float> x, y;
+        for (const SampleBucket &b : buckets) {
+          x.push_back((float)((b.index + 0.5) * ch.getBucketSeconds()));
+          y.push_back(b.meanSpeed());
+        }
+        for (size_t i : lttb(x, y, pointsPerDriver)) {
+          const SampleBucket &b = buckets[i];
+          file << raceId << "," << driverId << "," << x[i] << ","
+               << lapAtTime((int)raceId, driverId, x[i]) << "," << y[i] << ","
+               << b.minSpeed << "," << b.maxSpeed << "," << b.last.x << ","
+               << b.last.y << "\n";
+        }
+      });
+    }
+    file.close();
+    Log::info() << "Sample traces exported to " << filename;
+  }
+
+  CumulativeTimeIndex *getTimeIndex(int raceId) {
+    if (raceId < 0 || raceId >= (int)raceTimeIndex.size())
+      return nullptr;
+    return &raceTimeIndex[raceId];
+  }
+
+  // Rolling window length for races started after this call
+  void setPaceWindow(int laps) { paceWindow = laps > 0 ? laps : 1; }
+
+  PaceTracker *getPaceTracker(int raceId) {
+    if (raceId < 0 || raceId >= (int)racePace.size())
+      return nullptr;
+    return &racePace[raceId];
   }
 
   // Getters
+  int getCurrentRaceIndex() const { return currentRaceIndex; }
+  const std::vector<RaceResult> &getSeasonHistory() const {
+    return seasonHistory;
+  }
+  // Live heap, engine thread only (other threads use readLeaderboard)
   MaxHeap *getLeaderboard() { return leaderboard; }
   DriverRegistry *getRegistry() { return registry; }
 };
@@ -0,0 +1,98 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Little helpers for the binary season snapshot. Values are written in host
+// byte order (the snapshot is a restart cache, not an interchange format);
+// the header records the byte order so a foreign snapshot is rejected.
+//
+// File layout:
+//   magic "RLSN" | u32 version | u32 byteOrderMark | u64 payloadSize
+//   payload bytes | u64 FNV-1a checksum of payload
+namespace Snapshot {
+
+const char MAGIC[4] = {'R', 'L', 'S', 'N'};
+const uint32_t VERSION = 3;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+inline uint64_t checksum(const char *data, size_t size) {
+  uint64_t hash = 1469598103934665603ULL; // FNV-1a offset basis
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+class Writer {
+private:
+  std::vector<char> buffer;
+
+public:
+  template <typename T> void write(T value) {
+    const char *p = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(T));
+  }
+
+  void writeString(const std::string &s) {
+    write<uint32_t>((uint32_t)s.size());
+    buffer.insert(buffer.end(), s.begin(), s.end());
+  }
+
+  const std::vector<char> &data() const { return buffer; }
+};
+
+// Bounds-checked reader; once a read runs past the end, ok() stays false and
+// every further read returns a default value.
+class Reader {
+private:
+  const char *data;
+  size_t size;
+  size_t pos;
+  bool valid;
+
+public:
+  Reader(const char *d, size_t s) : data(d), size(s), pos(0), valid(true) {}
+
+  template <typename T> T read() {
+    T value{};
+    if (!valid || size - pos < sizeof(T)) {
+      valid = false;
+      return value;
+    }
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+
+  std::string readString() {
+    uint32_t len = read<uint32_t>();
+    if (!valid || size - pos < len) {
+      valid = false;
+      return "";
+    }
+    std::string s(data + pos, len);
+    pos += len;
+    return s;
+  }
+
+  // Guards container sizes read from the file before allocating
+  bool canHold(uint64_t count, size_t minBytesEach) {
+    if (!valid || count > (size - pos) / (minBytesEach ? minBytesEach : 1)) {
+      valid = false;
+    }
+    return valid;
+  }
+
+  void fail() { valid = false; }
+  bool ok() const { return valid; }
+  bool atEnd() const { return pos == size; }
+};
+
+} // namespace Snapshot
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,242 @@
+#ifndef TYRE_DEGRADATION_H
+#define TYRE_DEGRADATION_H
+
+#include "HashMap.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct DegradationLimits {
+  float fuelPerLap = 0.06f; // Lap time (s) gained per lap of fuel burnt
+  float wornLoss = 3.0f;    // Fitted time loss (s) reported as 100% wear
+  int minLaps = 4;          // Samples before a fit replaces its fallback
+};
+
+// Ordinary least squares y = a + b x over running sums: O(1) per sample
+struct LinearFit {
+  int n = 0;
+  double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+  void add(double x, double y) {
+    n++;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+
+  // Sums of deviations from the means
+  double cxx() const { return n > 0 ? sxx - sx * sx / n : 0.0; }
+  double cxy() const { return n > 0 ? sxy - sx * sy / n : 0.0; }
+
+  double slope() const {
+    double d = cxx();
+    return d > 1e-9 ? cxy() / d : 0.0;
+  }
+  double intercept() const { return n > 0 ? (sy - slope() * sx) / n : 0.0; }
+};
+
+// One set of tyres: fuel-corrected lap time against tyre age
+struct TyreStint {
+  std::string driverId;
+  std::string compound; // Empty until the COMPOUND event
+  int startLap;         // Pit lap (0 = from the grid)
+  LinearFit fit;
+};
+
+// Every stint on one compound at one track, pooled within stints (each
+// stint centred on its own means, so driver pace does not bias the slope)
+struct CompoundFit {
+  std::string compound;
+  int stints = 0;
+  int laps = 0;
+  double cxx = 0.0, cxy = 0.0;
+
+  double slope() const { return cxx > 1e-9 ? cxy / cxx : 0.0; }
+};
+
+// A driver's tyres as of the end of a lap
+struct TyreEstimate {
+  int stint = -1;            // Index into getStints(), -1 = none
+  float rate = 0.0f;         // Fitted loss per lap of tyre age (s)
+  float degradation = 0.0f;  // max(rate, 0) x age / wornLoss, in percent
+};
+
+// Online tyre model for one race (= one track). Lap times are fuel
+// corrected (t - fuelPerLap x laps remaining) and added to the driver's
+// current stint fit and to its compound's pooled fit, both O(1). The out
+// lap, the in lap and laps the caller marks unclean (neutralized, outliers)
+// are not fitted. A driver's rate is the stint fit once it has minLaps
+// samples, else the compound fit, else 0.
+//
+// Estimates are kept per lap so the driver-major batch path can read what
+// the lap-major path saw after each lap.
+class TyreDegradationModel {
+public:
+  struct State {
+    std::vector<TyreStint> stints;
+    std::vector<CompoundFit> compounds;
+    std::vector<int> openStint;
+  };
+
+private:
+  DegradationLimits limits;
+  int raceLaps;
+
+  HashMap<std::string, int> slotOf; // Driver -> Slot
+  std::vector<int> openStint;       // Slot -> Stint, -1 = none yet
+  std::vector<TyreStint> stints;
+  std::vector<CompoundFit> compounds;
+  std::vector<std::vector<TyreEstimate>> estimates; // Lap -> Slot
+
+  int slot(const std::string &driverId) {
+    const int *s = slotOf.find(driverId);
+    if (s)
+      return *s;
+    int next = (int)openStint.size();
+    slotOf.put(driverId, next);
+    openStint.push_back(-1);
+    return next;
+  }
+
+  int openFor(const std::string &driverId, int lap) {
+    int s = slot(driverId);
+    if (openStint[s] < 0)
+      beginStint(driverId, lap);
+    return openStint[s];
+  }
+
+  CompoundFit *compoundFit(const std::string &compound, bool create) {
+    for (CompoundFit &c : compounds) {
+      if (c.compound == compound)
+        return &c;
+    }
+    if (!create)
+      return nullptr;
+    compounds.push_back(CompoundFit());
+    compounds.back().compound = compound;
+    return &compounds.back();
+  }
+
+  float rateOf(const TyreStint &s) const {
+    if (s.fit.n >= limits.minLaps)
+      return (float)s.fit.slope();
+    for (const CompoundFit &c : compounds) {
+      if (c.compound == s.compound && c.laps >= limits.minLaps)
+        return (float)c.slope();
+    }
+    return 0.0f;
+  }
+
+public:
+  explicit TyreDegradationModel(const DegradationLimits &l = DegradationLimits(),
+                                int totalLaps = 0)
+      : limits(l), raceLaps(totalLaps), slotOf(64) {}
+
+  // New tyres fitted on `lap` (PIT event)
+  void beginStint(const std::string &driverId, int lap) {
+    int s = slot(driverId);
+    TyreStint stint;
+    stint.driverId = driverId;
+    stint.startLap = lap;
+    openStint[s] = (int)stints.size();
+    stints.push_back(stint);
+  }
+
+  // COMPOUND event. A different compound on a stint that already has laps
+  // starts a new stint.
+  void setCompound(const std::string &driverId, int lap,
+                   const std::string &compound) {
+    int i = openFor(driverId, lap);
+    if (!stints[i].compound.empty() && stints[i].compound != compound &&
+        stints[i].fit.n > 0) {
+      beginStint(driverId, lap);
+      i = openStint[slot(driverId)];
+    }
+    stints[i].compound = compound;
+  }
+
+  // LAP event. `clean` = false keeps the lap out of the fits.
+  void recordLap(const std::string &driverId, int lap, float time,
+                 bool clean) {
+    TyreStint &s = stints[openFor(driverId, lap)];
+    int age = lap - s.startLap;
+    if (!clean || time <= 0.0f || age <= 1) // In lap (0), out lap (1)
+      return;
+    double corrected = time - limits.fuelPerLap * std::max(0, raceLaps - lap);
+    double cxx = s.fit.cxx(), cxy = s.fit.cxy();
+    s.fit.add(age, corrected);
+    if (s.compound.empty())
+      return;
+    CompoundFit *c = compoundFit(s.compound, true);
+    c->cxx += s.fit.cxx() - cxx;
+    c->cxy += s.fit.cxy() - cxy;
+    c->laps++;
+    if (s.fit.n == 1)
+      c->stints++;
+  }
+
+  // Stores every driver's estimate as of the end of `lap` (replacing
+  // later laps, e.g. after a live rewind)
+  void finalizeLap(int lap) {
+    if (lap < 0)
+      return;
+    estimates.resize(lap + 1);
+    std::vector<TyreEstimate> &row = estimates[lap];
+    row.assign(openStint.size(), TyreEstimate());
+    for (size_t s = 0; s < openStint.size(); ++s) {
+      if (openStint[s] < 0)
+        continue;
+      const TyreStint &stint = stints[openStint[s]];
+      TyreEstimate &e = row[s];
+      e.stint = openStint[s];
+      e.rate = rateOf(stint);
+      float loss = std::max(0.0f, e.rate) * (lap - stint.startLap);
+      e.degradation =
+          limits.wornLoss > 0.0f
+              ? std::min(100.0f, 100.0f * loss / limits.wornLoss)
+              : 0.0f;
+    }
+  }
+
+  // nullptr if the driver had no tyres fitted by then
+  const TyreEstimate *estimateAt(int lap, const std::string &driverId) const {
+    const int *s = slotOf.find(driverId);
+    if (!s || lap < 0 || lap >= (int)estimates.size() ||
+        *s >= (int)estimates[lap].size() || estimates[lap][*s].stint < 0)
+      return nullptr;
+    return &estimates[lap][*s];
+  }
+
+  // Live rewinds: fits as of a checkpoint, estimates after `lap` dropped
+  State saveState() const { return State{stints, compounds, openStint}; }
+  void restoreState(const State &st, int lap) {
+    stints = st.stints;
+    compounds = st.compounds;
+    for (size_t s = 0; s < openStint.size(); ++s)
+      openStint[s] = s < st.openStint.size() ? st.openStint[s] : -1;
+    estimates.resize(std::max(0, lap + 1));
+  }
+
+  const std::vector<TyreStint> &getStints() const { return stints; }
+  const std::vector<CompoundFit> &getCompounds() const { return compounds; }
+  const DegradationLimits &getLimits() const { return limits; }
+
+  MemoryAccounting::Usage memoryUsage() const {
+    using namespace MemoryAccounting;
+    Usage u;
+    u.add(slotOf.footprint() + vectorHeap(openStint) + vectorHeap(stints) +
+              vectorHeap(compounds) + vectorHeap(estimates),
+          stints.size() + compounds.size());
+    for (const TyreStint &s : stints)
+      u.add(stringHeap(s.driverId) + stringHeap(s.compound));
+    for (const CompoundFit &c : compounds)
+      u.add(stringHeap(c.compound));
+    for (const auto &row : estimates)
+      u.add(vectorHeap(row), row.size());
+    return u;
+  }
+};
+
+#endif // TYRE_DEGRADATION_H
@@ -0,0 +1,252 @@
+#ifndef WHAT_IF_STANDINGS_H
+#define WHAT_IF_STANDINGS_H
+
+#include "HashMap.h"
+#include "SeasonExport.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A points system to score stored race results with
+struct PointsRules {
+  std::string name;
+  std::vector<int> pointsTable; // Index 0 = P1
+  int fastestLapBonus = 0;      // Awarded if the driver finishes in the...
+  int fastestLapMaxPosition = 10; // ...top N
+  bool dnfScores = true;        // Classified DNFs score like finishers
+  std::vector<int> excludedRaces; // RaceIDs ignored by this rule set
+
+  int pointsFor(const RaceResult &race, const DriverResult &res) const {
+    if (std::find(excludedRaces.begin(), excludedRaces.end(), race.raceId) !=
+        excludedRaces.end())
+      return 0;
+    if (res.status == "DSQ" || (!dnfScores && res.status == "DNF"))
+      return 0;
+    int pts = 0;
+    if (res.position >= 1 && res.position <= (int)pointsTable.size())
+      pts = pointsTable[res.position - 1];
+    if (fastestLapBonus != 0 && res.name == race.fastestLapDriver &&
+        res.position <= fastestLapMaxPosition)
+      pts += fastestLapBonus;
+    return pts;
+  }
+
+  // Built-in tables: "current", "current+fl", "2003", "1991", "top15".
+  // Each may be followed by "-<raceId>" suffixes to drop races, e.g.
+  // "2003-2-5".
+  static bool preset(const std::string &spec, PointsRules &out) {
+    out = PointsRules();
+    out.name = spec;
+    std::string id = spec;
+    size_t dash;
+    while ((dash = id.rfind('-')) != std::string::npos &&
+           dash + 1 < id.size() &&
+           id.find_first_not_of("0123456789", dash + 1) == std::string::npos) {
+      out.excludedRaces.push_back(std::stoi(id.substr(dash + 1)));
+      id.erase(dash);
+    }
+    if (id == "current" || id == "current+fl") {
+      out.pointsTable = {25, 18, 15, 12, 10, 8, 6, 4, 2, 1};
+      if (id == "current+fl")
+        out.fastestLapBonus = 1;
+    } else if (id == "2003") {
+      out.pointsTable = {10, 8, 6, 5, 4, 3, 2, 1};
+    } else if (id == "1991") {
+      out.pointsTable = {10, 6, 4, 3, 2, 1};
+    } else if (id == "top15") {
+      out.pointsTable = {25, 20, 17, 15, 13, 11, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+struct WhatIfRow {
+  std::string name;
+  std::string team;
+  int points;
+  int wins;
+  int podiums;
+};
+
+// Season standings materialized for several rule sets at once, computed from
+// stored RaceResults (no event reprocessing). addRace() updates every rule
+// set in one pass over the race; rule changes only rescore what they touch.
+class WhatIfStandings {
+private:
+  std::vector<PointsRules> rules;
+  std::vector<RaceResult> races; // Copies: the source history may grow
+
+  // Driver slots (by name, in first-seen order)
+  HashMap<std::string, int> slotOf;
+  std::vector<std::string> names;
+  std::vector<std::string> teams;
+  std::vector<int> wins;
+  std::vector<int> podiums;
+
+  std::vector<std::vector<int>> points; // Rule -> Slot -> Points
+
+  int slotFor(const DriverResult &res) {
+    const int *slot = slotOf.find(res.name);
+    if (slot)
+      return *slot;
+    int s = (int)names.size();
+    slotOf.put(res.name, s);
+    names.push_back(res.name);
+    teams.push_back(res.team);
+    wins.push_back(0);
+    podiums.push_back(0);
+    for (auto &p : points)
+      p.push_back(0);
+    return s;
+  }
+
+  // Every rule set in one pass over the race
+  void scoreRace(const RaceResult &race) {
+    for (const DriverResult &res : race.results) {
+      int slot = slotFor(res);
+      for (size_t r = 0; r < rules.size(); ++r)
+        points[r][slot] += rules[r].pointsFor(race, res);
+    }
+  }
+
+  void rescoreRule(size_t r) {
+    std::fill(points[r].begin(), points[r].end(), 0);
+    for (const RaceResult &race : races) {
+      for (const DriverResult &res : race.results)
+        points[r][slotFor(res)] += rules[r].pointsFor(race, res);
+    }
+  }
+
+public:
+  WhatIfStandings() : slotOf(64) {}
+
+  // A rule set added after races is scored against every stored race
+  int addRules(const PointsRules &r) {
+    rules.push_back(r);
+    points.emplace_back(names.size(), 0);
+    rescoreRule(rules.size() - 1);
+    return (int)rules.size() - 1;
+  }
+
+  void addRace(const RaceResult &race) {
+    races.push_back(race);
+    for (const DriverResult &res : race.results) {
+      int slot = slotFor(res);
+      if (res.position == 1)
+        wins[slot]++;
+      if (res.position >= 1 && res.position <= 3)
+        podiums[slot]++;
+    }
+    scoreRace(race);
+  }
+
+  void addRaces(const std::vector<RaceResult> &history) {
+    for (const RaceResult &r : history)
+      addRace(r);
+  }
+
+  // Swaps in a corrected result (e.g. after a penalty); only that race's
+  // contribution is taken back out and rescored
+  void replaceRace(const RaceResult &race) {
+    for (RaceResult &stored : races) {
+      if (stored.raceId != race.raceId)
+        continue;
+      for (const DriverResult &res : stored.results) {
+        int slot = slotFor(res);
+        wins[slot] -= res.position == 1;
+        podiums[slot] -= res.position >= 1 && res.position <= 3;
+        for (size_t r = 0; r < rules.size(); ++r)
+          points[r][slot] -= rules[r].pointsFor(stored, res);
+      }
+      stored = race;
+      for (const DriverResult &res : race.results) {
+        int slot = slotFor(res);
+        wins[slot] += res.position == 1;
+        podiums[slot] += res.position >= 1 && res.position <= 3;
+      }
+      scoreRace(race);
+      return;
+    }
+  }
+
+  // Excludes (or restores) one race for one rule set; only that race is
+  // rescored
+  void setRaceExcluded(int rule, int raceId, bool excluded) {
+    PointsRules &r = rules[rule];
+    auto it = std::find(r.excludedRaces.begin(), r.excludedRaces.end(), raceId);
+    if ((it != r.excludedRaces.end()) == excluded)
+      return;
+    for (const RaceResult &race : races) {
+      if (race.raceId == raceId)
+        for (const DriverResult &res : race.results)
+          points[rule][slotFor(res)] -= r.pointsFor(race, res);
+    }
+    if (excluded)
+      r.excludedRaces.push_back(raceId);
+    else
+      r.excludedRaces.erase(it);
+    for (const RaceResult &race : races) {
+      if (race.raceId == raceId)
+        for (const DriverResult &res : race.results)
+          points[rule][slotFor(res)] += r.pointsFor(race, res);
+    }
+  }
+
+  int getRuleCount() const { return (int)rules.size(); }
+  const PointsRules &getRules(int rule) const { return rules[rule]; }
+
+  // Points, then wins, then podiums (countback), then first-seen order
+  std::vector<WhatIfRow> standings(int rule) const {
+    std::vector<WhatIfRow> rows;
+    for (size_t s = 0; s < names.size(); ++s)
+      rows.push_back({names[s], teams[s], points[rule][s], wins[s], podiums[s]});
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const WhatIfRow &a, const WhatIfRow &b) {
+                       if (a.points != b.points)
+                         return a.points > b.points;
+                       if (a.wins != b.wins)
+                         return a.wins > b.wins;
+                       return a.podiums > b.podiums;
+                     });
+    return rows;
+  }
+
+  // One row per driver (ordered by the first rule set), one "rank points"
+  // column per rule set
+  void printComparison(std::ostream &out) const {
+    if (rules.empty())
+      return;
+    std::ios::fmtflags flags = out.flags();
+    std::vector<std::vector<WhatIfRow>> tables;
+    std::vector<HashMap<std::string, int>> rankOf;
+    for (size_t r = 0; r < rules.size(); ++r) {
+      tables.push_back(standings((int)r));
+      rankOf.emplace_back(64);
+      for (size_t i = 0; i < tables[r].size(); ++i)
+        rankOf[r].put(tables[r][i].name, (int)i);
+    }
+
+    out << std::left << std::setw(22) << "Driver";
+    for (const PointsRules &r : rules)
+      out << std::right << std::setw(14) << r.name;
+    out << "\n";
+
+    for (const WhatIfRow &row : tables[0]) {
+      out << std::left << std::setw(22) << row.name;
+      for (size_t r = 0; r < tables.size(); ++r) {
+        int i = *rankOf[r].find(row.name);
+        std::string cell = "P" + std::to_string(i + 1) + " " +
+                           std::to_string(tables[r][i].points);
+        out << std::right << std::setw(14) << cell;
+      }
+      out << "\n";
+    }
+    out.flags(flags);
+  }
+};
+
+#endif // WHAT_IF_STANDINGS_H
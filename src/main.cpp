@@ -1,60 +1,1009 @@
+#include "Logger.h"
+#include "PerfCounters.h"
+#include "RaceLaps.h"
 #include "SeasonManager.h"
+#include "WhatIfStandings.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
-int main() {
-  std::cout << "Initializing RaceLogic v0.1 (Data-Driven Mode)..." << std::endl;
+// Ingest scaling curve: the tape is replicated `copies` times (race ids
+// shifted so every copy is a distinct race) and loaded with 1..16 threads.
+static int runIngestBenchmark(int copies) {
+  std::ifstream tape("data/race_events.txt");
+  if (!tape.is_open()) {
+    Log::error() << "Failed to open event file: data/race_events.txt";
+    return 1;
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  int maxRace = 0;
+  while (std::getline(tape, line)) {
+    lines.push_back(line);
+    size_t begin = line.rfind("BATCH,", 0) == 0 ? 6 : 0;
+    maxRace = std::max(maxRace, std::atoi(line.c_str() + begin));
+  }
 
-  SeasonManager season;
+  std::string benchFile =
+      (std::filesystem::temp_directory_path() / "racelogic_bench_tape.txt")
+          .string();
+  {
+    std::ofstream out(benchFile, std::ios::binary | std::ios::trunc);
+    for (int k = 0; k < copies; ++k) {
+      for (const auto &l : lines) {
+        size_t begin = l.rfind("BATCH,", 0) == 0 ? 6 : 0;
+        size_t comma = l.find(',', begin);
+        if (comma == std::string::npos)
+          continue;
+        int race = std::atoi(l.c_str() + begin) + k * maxRace;
+        out << l.substr(0, begin) << race << l.substr(comma) << "\n";
+      }
+    }
+  }
+  double megabytes = std::filesystem::file_size(benchFile) / (1024.0 * 1024.0);
+
+  Log::info() << "Ingest benchmark: " << copies << " copies, " << std::fixed
+              << std::setprecision(1) << megabytes << " MB, "
+              << std::thread::hardware_concurrency() << " hardware threads";
+  Log::info() << "threads,ms,speedup,MB/s";
+
+  double baseline = 0.0;
+  for (int threads : {1, 2, 4, 8, 16}) {
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+      SeasonManager season;
+      LogLevel saved = Logger::instance().getConsoleLevel();
+      Logger::instance().setConsoleLevel(LogLevel::Warn); // Mute loader output
+      auto start = std::chrono::steady_clock::now();
+      season.loadRaceEventsParallel(benchFile, threads);
+      auto stop = std::chrono::steady_clock::now();
+      Logger::instance().setConsoleLevel(saved);
+      double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+      if (run == 0 || ms < best)
+        best = ms;
+    }
+    if (threads == 1)
+      baseline = best;
+    Log::info() << threads << "," << std::fixed << std::setprecision(2) << best
+                << "," << baseline / best << ","
+                << megabytes / (best / 1000.0);
+  }
+  std::filesystem::remove(benchFile);
+  return 0;
+}
+
+static bool sameResult(const DriverResult &x, const DriverResult &y) {
+  return x.name == y.name && x.points == y.points &&
+         x.totalTime == y.totalTime && x.pitStops == y.pitStops &&
+         x.overtakes == y.overtakes &&
+         x.tyreDegradation == y.tyreDegradation &&
+         x.degradationRate == y.degradationRate && x.score == y.score &&
+         x.position == y.position && x.status == y.status &&
+         x.bestLap == y.bestLap && x.avgLap == y.avgLap &&
+         x.lapStdDev == y.lapStdDev;
+}
+
+// Self-check for the driver-major batch path: runs the season both ways and
+// requires bit-identical results (history, standings, pace and gap tables).
+static int verifyBatchMode() {
+  SeasonManager lapMajor, driverMajor;
+  SeasonManager *seasons[2] = {&lapMajor, &driverMajor};
+
+  LogLevel saved = Logger::instance().getConsoleLevel();
+  Logger::instance().setConsoleLevel(LogLevel::Warn); // Mute race reports
+  for (SeasonManager *s : seasons) {
+    s->loadDriversFromFile("data/drivers.txt");
+    s->loadIdealLapTimes("data/ideal_lap_times.txt");
+    s->loadRaceEvents("data/race_events.txt");
+  }
+  for (int race = 1; race <= 5; ++race) {
+    lapMajor.startRace(race);
+    for (int lap = 0; lap <= lapMajor.getRaceLapCount(race); ++lap)
+      lapMajor.processRaceLap(race, lap);
+    lapMajor.endRace();
+
+    driverMajor.runRaceBatch(race);
+    driverMajor.endRace();
+  }
+  Logger::instance().setConsoleLevel(saved);
+
+  int mismatches = 0;
+  auto check = [&](bool same, const std::string &what) {
+    if (!same) {
+      Log::error() << "MISMATCH: " << what;
+      mismatches++;
+    }
+  };
+
+  const auto &a = lapMajor.getSeasonHistory();
+  const auto &b = driverMajor.getSeasonHistory();
+  check(a.size() == b.size(), "race count");
+  for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+    std::string race = "race " + std::to_string(a[i].raceId);
+    check(a[i].fastestLapDriver == b[i].fastestLapDriver &&
+              a[i].fastestLapTime == b[i].fastestLapTime &&
+              a[i].fastestLap == b[i].fastestLap,
+          race + " fastest lap");
+    check(a[i].results.size() == b[i].results.size(), race + " field size");
+    for (size_t j = 0; j < a[i].results.size() && j < b[i].results.size();
+         ++j) {
+      check(sameResult(a[i].results[j], b[i].results[j]),
+            race + " P" + std::to_string(j + 1));
+    }
+
+    CumulativeTimeIndex *ta = lapMajor.getTimeIndex(a[i].raceId);
+    CumulativeTimeIndex *tb = driverMajor.getTimeIndex(b[i].raceId);
+    std::vector<std::string> rowsA, rowsB;
+    auto collect = [](std::vector<std::string> &rows) {
+      return [&rows](int lap, int pos, const std::string &id, float t,
+                     float gap, float interval) {
+        rows.push_back(std::to_string(lap) + "," + std::to_string(pos) + "," +
+                       id + "," + std::to_string(t) + "," +
+                       std::to_string(gap) + "," + std::to_string(interval));
+      };
+    };
+    if (ta && tb) {
+      ta->forEachEntry(collect(rowsA));
+      tb->forEachEntry(collect(rowsB));
+    }
+    check(rowsA == rowsB, race + " gap table");
+  }
+
+  std::vector<Driver *> sa = lapMajor.getSeasonStandings();
+  std::vector<Driver *> sb = driverMajor.getSeasonStandings();
+  check(sa.size() == sb.size(), "standings size");
+  for (size_t k = 0; k < sa.size() && k < sb.size(); ++k) {
+    check(sa[k]->getId() == sb[k]->getId() &&
+              sa[k]->getSeasonPoints() == sb[k]->getSeasonPoints() &&
+              sa[k]->getSeasonTotalTime() == sb[k]->getSeasonTotalTime(),
+          "standings P" + std::to_string(k + 1));
+  }
+
+  Log::info() << (mismatches == 0 ? "Batch mode matches lap-major results."
+                                  : "Batch mode verification FAILED.");
+  return mismatches == 0 ? 0 : 1;
+}
+
+// Self-check for snapshots of a lazily loaded season: runs races 1 and 3 from
+// the indexed tape, snapshots, resumes into a fresh manager and runs the
+// remaining races there. Every race result and the standings must match an
+// uninterrupted season.
+static int verifyResumeMode() {
+  const std::string snapshotFile = "dashboard/verify_resume.snapshot";
+  // Non-contiguous: races 1 and 3 before the snapshot. The uninterrupted
+  // season runs the same order, since the field of a race depends on which
+  // drivers earlier rounds classified.
+  const int order[] = {1, 3, 2, 4, 5};
+  const int beforeSnapshot = 2;
+  SeasonManager full, first, resumed;
+  auto runRace = [](SeasonManager &s, int race) {
+    s.startRace(race);
+    for (int lap = 0; lap <= s.getRaceLapCount(race); ++lap)
+      s.processRaceLap(race, lap);
+    s.endRace();
+  };
+
+  LogLevel saved = Logger::instance().getConsoleLevel();
+  Logger::instance().setConsoleLevel(LogLevel::Warn); // Mute race reports
+  full.loadDriversFromFile("data/drivers.txt");
+  full.loadIdealLapTimes("data/ideal_lap_times.txt");
+  full.loadRaceEvents("data/race_events.txt");
+  for (int race : order)
+    runRace(full, race);
+
+  first.loadDriversFromFile("data/drivers.txt");
+  first.loadIdealLapTimes("data/ideal_lap_times.txt");
+  bool ok = first.openRaceEvents("data/race_events.txt");
+  if (ok) {
+    for (int k = 0; k < beforeSnapshot; ++k)
+      runRace(first, order[k]);
+    ok = first.saveSnapshot(snapshotFile) && resumed.loadSnapshot(snapshotFile);
+  }
+  std::remove(snapshotFile.c_str());
+  if (ok) {
+    for (int race : order) {
+      bool done = false;
+      for (const RaceResult &r : resumed.getSeasonHistory())
+        done = done || r.raceId == race;
+      if (!done)
+        runRace(resumed, race);
+    }
+  }
+  Logger::instance().setConsoleLevel(saved);
+  if (!ok) {
+    Log::error() << "Resume verification FAILED: snapshot round trip failed.";
+    return 1;
+  }
 
-  // Register Drivers from file
+  int mismatches = 0;
+  auto check = [&](bool same, const std::string &what) {
+    if (!same) {
+      Log::error() << "MISMATCH: " << what;
+      mismatches++;
+    }
+  };
+
+  const auto &a = full.getSeasonHistory();
+  const auto &b = resumed.getSeasonHistory();
+  check(a.size() == b.size(), "race count");
+  for (const RaceResult &x : a) {
+    std::string race = "race " + std::to_string(x.raceId);
+    const RaceResult *y = nullptr;
+    for (const RaceResult &r : b) {
+      if (r.raceId == x.raceId)
+        y = &r;
+    }
+    if (!y) {
+      check(false, race + " not run after resume");
+      continue;
+    }
+    check(x.trackName == y->trackName && x.weather == y->weather,
+          race + " track / weather");
+    check(x.fastestLapDriver == y->fastestLapDriver &&
+              x.fastestLapTime == y->fastestLapTime &&
+              x.fastestLap == y->fastestLap,
+          race + " fastest lap");
+    check(x.results.size() == y->results.size(), race + " field size");
+    for (size_t j = 0; j < x.results.size() && j < y->results.size(); ++j)
+      check(sameResult(x.results[j], y->results[j]),
+            race + " P" + std::to_string(j + 1));
+  }
+
+  std::vector<Driver *> sa = full.getSeasonStandings();
+  std::vector<Driver *> sb = resumed.getSeasonStandings();
+  check(sa.size() == sb.size(), "standings size");
+  for (size_t k = 0; k < sa.size() && k < sb.size(); ++k) {
+    check(sa[k]->getId() == sb[k]->getId() &&
+              sa[k]->getSeasonPoints() == sb[k]->getSeasonPoints() &&
+              sa[k]->getSeasonTotalTime() == sb[k]->getSeasonTotalTime(),
+          "standings P" + std::to_string(k + 1));
+  }
+
+  Log::info() << (mismatches == 0 ? "Resumed season matches an uninterrupted one."
+                                  : "Resume verification FAILED.");
+  return mismatches == 0 ? 0 : 1;
+}
+
+// Prints the laps of one race where the lead changed hands. Laps are pulled
+// lazily from RaceLaps; nothing past the last lap of the race is computed.
+static int printLeaderChanges(int raceId) {
+  SeasonManager season;
   season.loadDriversFromFile("data/drivers.txt");
   season.loadIdealLapTimes("data/ideal_lap_times.txt");
+  if (!season.openRaceEvents("data/race_events.txt"))
+    return 1;
+
+  Log::info() << "Leader changes in race " << raceId << ":";
+  for (const LapSnapshot &snap :
+       filterLaps(RaceLaps(season, raceId), leaderChanged)) {
+    LogLine line = Log::info();
+    line << "  Lap " << snap.lap << ": " << snap.leader;
+    if (!snap.previousLeader.empty())
+      line << " (from " << snap.previousLeader << ")";
+  }
+  return 0;
+}
 
-  // Load Race Events
+// Answers one ad-hoc event query (see EventQuery::parse) from the bitmap
+// indexes built at load time, printing up to 50 matching events
+static int runEventQuery(const std::string &text) {
+  EventQuery query;
+  std::string error;
+  if (!EventQuery::parse(text, query, error)) {
+    Log::error() << error;
+    return 1;
+  }
+
+  LogLevel console = Logger::instance().getConsoleLevel();
+  Logger::instance().setConsoleLevel(LogLevel::Warn);
+  SeasonManager season;
+  season.loadDriversFromFile("data/drivers.txt");
   season.loadRaceEvents("data/race_events.txt");
+  Logger::instance().setConsoleLevel(console);
+
+  auto start = std::chrono::steady_clock::now();
+  RoaringBitmap matches = season.queryEvents(query);
+  auto stop = std::chrono::steady_clock::now();
+  double us = std::chrono::duration<double, std::micro>(stop - start).count();
+
+  const EventQueryIndex &index = season.getEventQueryIndex();
+  static const char *compounds[] = {"-", "Soft", "Medium", "Hard",
+                                    "Intermediate", "Wet"};
+  const size_t limit = 50;
+  size_t shown = 0;
+  Log::info() << "Race  Lap  Driver  Type       Value  Compound";
+  matches.forEach([&](uint32_t row) {
+    if (shown++ >= limit)
+      return;
+    const EventRow &r = index.getRow(row);
+    Log::info() << std::left << std::setw(6) << r.raceId << std::setw(5)
+                << r.lap << std::setw(8) << index.driverName(r.driverSlot)
+                << std::setw(9) << index.typeName(r.typeCode) << std::right
+                << std::setw(7) << r.value << "  "
+                << compounds[r.compound < 6 ? r.compound : 0];
+  });
+  size_t total = matches.cardinality();
+  if (total > limit)
+    Log::info() << "... " << (total - limit) << " more";
+  Log::info() << total << " of " << index.getRowCount() << " events matched in "
+              << std::fixed << std::setprecision(1) << us << " us";
+  return 0;
+}
+
+// Calibrates ScoringEngine weights: every race is replayed once to record
+// the per-lap scoring inputs, then each candidate weight vector is scored
+// against the real classifications (Kendall / Spearman) in parallel.
+// `spec` = grid:<steps> or random:<count>[:<seed>]
+static int runScoringSweep(const std::string &spec, int threads,
+                           bool filterNeutralized) {
+  std::vector<ScoringWeights> candidates;
+  std::stringstream ss(spec);
+  std::string kind, count, seed;
+  std::getline(ss, kind, ':');
+  std::getline(ss, count, ':');
+  std::getline(ss, seed, ':');
+  int n = std::atoi(count.c_str());
+  if (kind == "grid" && n >= 2) {
+    candidates = ScoringSweep::grid(n);
+  } else if (kind == "random" && n > 0) {
+    candidates = ScoringSweep::random(
+        n, seed.empty() ? 1u : (unsigned)std::strtoul(seed.c_str(), 0, 10));
+  } else {
+    Log::error() << "Sweep must be grid:<steps> or random:<count>[:<seed>]: "
+                 << spec;
+    return 1;
+  }
+
+  SeasonManager season;
+  season.setNeutralizedLapFiltering(filterNeutralized);
+  ScoringSweep sweep;
+  LogLevel saved = Logger::instance().getConsoleLevel();
+  Logger::instance().setConsoleLevel(LogLevel::Warn); // Mute race reports
+  season.loadDriversFromFile("data/drivers.txt");
+  season.loadIdealLapTimes("data/ideal_lap_times.txt");
+  season.loadRaceEvents("data/race_events.txt");
+  for (int race = 1; race <= 5; ++race)
+    sweep.addRace(season.recordScoringRace(race));
+  Logger::instance().setConsoleLevel(saved);
+
+  auto started = std::chrono::steady_clock::now();
+  std::vector<SweepResult> results = sweep.run(candidates, threads);
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - started)
+                  .count();
+  SweepResult baseline = sweep.evaluate(ScoringWeights());
+
+  std::vector<SweepResult> best = results;
+  std::stable_sort(best.begin(), best.end(),
+                   [](const SweepResult &a, const SweepResult &b) {
+                     if (a.kendall != b.kendall)
+                       return a.kendall > b.kendall;
+                     return a.spearman > b.spearman;
+                   });
+
+  Log::info() << "Scoring sweep: " << candidates.size() << " weight vectors x "
+              << sweep.getRaces().size() << " races (" << sweep.getInputCount()
+              << " lap inputs) on " << threads << " threads in " << std::fixed
+              << std::setprecision(1) << ms << " ms";
+  std::ostringstream table;
+  table << std::left << std::setw(10) << "" << std::right << std::setw(9)
+        << "Kendall" << std::setw(9) << "Spearman";
+  for (int i = 0; i < ScoringWeights::COUNT; ++i)
+    table << std::setw(18) << ScoringWeights::name(i);
+  auto row = [&](const std::string &label, const SweepResult &r) {
+    table << "\n"
+          << std::left << std::setw(10) << label << std::right << std::fixed
+          << std::setprecision(4) << std::setw(9) << r.kendall << std::setw(9)
+          << r.spearman << std::setprecision(3);
+    for (int i = 0; i < ScoringWeights::COUNT; ++i)
+      table << std::setw(18) << r.weights[i];
+  };
+  row("current", baseline);
+  for (size_t i = 0; i < best.size() && i < 10; ++i)
+    row("#" + std::to_string(i + 1), best[i]);
+  Log::info() << table.str();
+
+  if (!ScoringSweep::exportCsv("dashboard/sweep.csv", results)) {
+    Log::error() << "Failed to write dashboard/sweep.csv";
+    return 1;
+  }
+  Log::info() << "All results written to dashboard/sweep.csv";
+  return 0;
+}
 
-  std::cout << "Drivers and Events Registered." << std::endl;
+// Stewards' decisions, one per line (see ResultCorrection::parse); blank
+// lines and # comments are skipped
+static bool loadCorrections(const std::string &filename,
+                            std::vector<ResultCorrection> &out) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    Log::error() << "Failed to open corrections file: " << filename;
+    return false;
+  }
+  std::string line, error;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty() || line[0] == '#')
+      continue;
+    ResultCorrection c;
+    if (!ResultCorrection::parse(line, c, error)) {
+      Log::error() << filename << ": " << error;
+      return false;
+    }
+    out.push_back(c);
+  }
+  return true;
+}
+
+// Runs `body` as one execution of a profiled phase (a plain call when
+// profiling is off)
+template <typename Func>
+static void profiled(PerfProfiler *profiler, const char *phase, Func body,
+                     long long events = 0) {
+  if (!profiler) {
+    body();
+    return;
+  }
+  PerfReading started = profiler->begin();
+  body();
+  profiler->end(started, phase, events);
+}
+
+// Threads polling the published leaderboard while the season runs, as a
+// dashboard or API publisher would. Each snapshot is checked for internal
+// consistency (rows 1..n, gaps from the leader) and versions must never go
+// backwards for a reader.
+class LeaderboardReaders {
+private:
+  const SeasonManager *season = nullptr;
+  std::vector<std::thread> threads;
+  std::atomic<bool> stopping{false};
+  std::atomic<long long> reads{0};
+  std::atomic<long long> inconsistent{0};
+  std::atomic<uint64_t> newestSeen{0};
+
+  static bool consistent(const LeaderboardSnapshot &s) {
+    for (size_t i = 0; i < s.rows.size(); ++i) {
+      const LeaderboardRow &r = s.rows[i];
+      if (r.position != (int)i + 1 || r.gap != r.raceTime - s.rows[0].raceTime)
+        return false;
+    }
+    return true;
+  }
+
+  void run() {
+    uint64_t lastVersion = 0;
+    while (!stopping.load()) {
+      LeaderboardPublisher::Reader r = season->readLeaderboard();
+      if (r) {
+        if (r->version < lastVersion || !consistent(*r))
+          inconsistent++;
+        lastVersion = r->version;
+        uint64_t seen = newestSeen.load();
+        while (seen < lastVersion &&
+               !newestSeen.compare_exchange_weak(seen, lastVersion)) {
+        }
+        reads++;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+public:
+  ~LeaderboardReaders() { stop(); }
+
+  void start(const SeasonManager &s, int count) {
+    season = &s;
+    for (int i = 0; i < count; ++i)
+      threads.emplace_back([this] { run(); });
+  }
+
+  void stop() {
+    stopping = true;
+    for (std::thread &t : threads)
+      t.join();
+    threads.clear();
+  }
+
+  long long getReads() const { return reads.load(); }
+  long long getInconsistent() const { return inconsistent.load(); }
+  uint64_t getNewestSeen() const { return newestSeen.load(); }
+};
+
+int main(int argc, char *argv[]) {
+  Log::info() << "Initializing RaceLogic v0.1 (Data-Driven Mode)...";
+
+  // Command line options
+  //   --snapshot <file>  checkpoint the season state after every race
+  //   --resume <file>    restore a checkpoint instead of re-reading inputs
+  //   --live <lag>       stream the event tape through the live reorder
+  //                      buffer, holding each lap open for <lag> laps
+  //   --races <a,b,...>  only parse and run the listed races (lazy loading)
+  //   --threads <n>      parse the event tape on n threads
+  //   --bench-ingest <k> print the ingest scaling curve (tape x k) and exit
+  //   --batch            evaluate races driver-major (no live leaderboard)
+  //   --verify-batch     check batch results against lap-major and exit
+  //   --verify-resume    check a lazily loaded, snapshotted and resumed season
+  //                      against an uninterrupted one and exit
+  //   --deltas <file>    write per-lap leaderboard changes as NDJSON
+  //   --deltas-bin <file> write per-lap leaderboard changes as binary records
+  //   --leader-changes <race> print the laps where the lead changed and exit
+  //   --query "<terms>"  print the events matching e.g. "type=PIT weather=wet"
+  //                      or "type=LAP value>120" and exit (see EventQuery)
+  //   --sweep <spec>     calibrate ScoringEngine weights against the recorded
+  //                      classifications (grid:<steps> or random:<n>[:seed],
+  //                      on --threads threads) and exit
+  //   --quiet            console shows warnings and errors only
+  //   --log-level <lvl>  console level: debug, info, warn, error, off
+  //   --log-file <file>  also write every log line (with timestamps) to file
+  //   --log-json <file>  also write every log line as NDJSON
+  //   --what-if <rules,...> compare final standings under other points
+  //                      tables, e.g. current,2003,1991-3 (see PointsRules)
+  //   --corrections <file> apply stewards' decisions (PENALTY,<race>,<driver>,
+  //                      +5s or DSQ,<race>,<driver>) once their race has ended
+  //   --neutralized      leave safety car / VSC laps and slow outlier laps out
+  //                      of pace and scoring stats, export them to
+  //                      dashboard/anomalies.csv
+  //   --battles          track head-to-head stats for every driver pair and
+  //                      export them to dashboard/battles.csv
+  //   --samples <file>   ingest high-frequency car samples (race,driver,t,
+  //                      speed,x,y) and export downsampled speed traces
+  //   --readers <n>      publish a leaderboard snapshot every lap and poll it
+  //                      from n reader threads while the season runs
+  //   --perf             read hardware counters per phase and lap (Linux)
+  //   --perf-laps <file> also write the per-lap counters as CSV
+  //   --memory-report    print memory use per structure and race at the end
+  //   --memory-budget <MB> evict finished races' raw events above this size
+  std::string snapshotFile = "";
+  std::string resumeFile = "";
+  int liveLag = -1;
+  std::vector<int> selectedRaces;
+  int loadThreads = 1;
+  int sweepThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+  std::string sweepSpec = "";
+  bool batchMode = false;
+  std::string deltasFile = "";
+  std::string deltasBinFile = "";
+  bool memoryReport = false;
+  std::vector<std::string> whatIfRules;
+  bool perfMode = false;
+  std::string samplesFile = "";
+  bool battles = false;
+  bool filterNeutralized = false;
+  int readerThreads = 0;
+  std::string correctionsFile = "";
+  std::string perfLapsFile = "";
+  double memoryBudgetMb = 0.0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--snapshot" && i + 1 < argc) {
+      snapshotFile = argv[++i];
+    } else if (arg == "--resume" && i + 1 < argc) {
+      resumeFile = argv[++i];
+    } else if (arg == "--live" && i + 1 < argc) {
+      liveLag = std::atoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      loadThreads = std::max(1, std::atoi(argv[++i]));
+      sweepThreads = loadThreads;
+    } else if (arg == "--bench-ingest" && i + 1 < argc) {
+      return runIngestBenchmark(std::max(1, std::atoi(argv[++i])));
+    } else if (arg == "--batch") {
+      batchMode = true;
+    } else if (arg == "--verify-batch") {
+      return verifyBatchMode();
+    } else if (arg == "--verify-resume") {
+      return verifyResumeMode();
+    } else if (arg == "--deltas" && i + 1 < argc) {
+      deltasFile = argv[++i];
+    } else if (arg == "--deltas-bin" && i + 1 < argc) {
+      deltasBinFile = argv[++i];
+    } else if (arg == "--leader-changes" && i + 1 < argc) {
+      return printLeaderChanges(std::atoi(argv[++i]));
+    } else if (arg == "--query" && i + 1 < argc) {
+      return runEventQuery(argv[++i]);
+    } else if (arg == "--sweep" && i + 1 < argc) {
+      sweepSpec = argv[++i];
+    } else if (arg == "--quiet") {
+      Logger::instance().setConsoleLevel(LogLevel::Warn);
+    } else if (arg == "--log-level" && i + 1 < argc) {
+      LogLevel level;
+      if (!parseLogLevel(argv[++i], level)) {
+        Log::error() << "Unknown log level: " << argv[i];
+        return 1;
+      }
+      Logger::instance().setConsoleLevel(level);
+    } else if (arg == "--log-file" && i + 1 < argc) {
+      FileLogSink *sink = new FileLogSink(argv[++i]);
+      if (!sink->isOpen()) {
+        Log::error() << "Failed to open log file: " << argv[i];
+        delete sink;
+        return 1;
+      }
+      Logger::instance().addSink(sink);
+    } else if (arg == "--log-json" && i + 1 < argc) {
+      NdjsonLogSink *sink = new NdjsonLogSink(argv[++i]);
+      if (!sink->isOpen()) {
+        Log::error() << "Failed to open log file: " << argv[i];
+        delete sink;
+        return 1;
+      }
+      Logger::instance().addSink(sink);
+    } else if (arg == "--what-if" && i + 1 < argc) {
+      std::stringstream ss(argv[++i]);
+      std::string item;
+      while (std::getline(ss, item, ','))
+        whatIfRules.push_back(item);
+    } else if (arg == "--corrections" && i + 1 < argc) {
+      correctionsFile = argv[++i];
+    } else if (arg == "--battles") {
+      battles = true;
+    } else if (arg == "--neutralized") {
+      filterNeutralized = true;
+    } else if (arg == "--samples" && i + 1 < argc) {
+      samplesFile = argv[++i];
+    } else if (arg == "--readers" && i + 1 < argc) {
+      readerThreads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--perf") {
+      perfMode = true;
+    } else if (arg == "--perf-laps" && i + 1 < argc) {
+      perfLapsFile = argv[++i];
+      perfMode = true;
+    } else if (arg == "--memory-report") {
+      memoryReport = true;
+    } else if (arg == "--memory-budget" && i + 1 < argc) {
+      memoryBudgetMb = std::atof(argv[++i]);
+      memoryReport = true;
+    } else if (arg == "--races" && i + 1 < argc) {
+      std::stringstream ss(argv[++i]);
+      std::string item;
+      while (std::getline(ss, item, ',')) {
+        int race = std::atoi(item.c_str());
+        if (race > 0)
+          selectedRaces.push_back(race);
+      }
+    } else {
+      Log::error() << "Unknown option: " << arg;
+      return 1;
+    }
+  }
+
+  if (!sweepSpec.empty())
+    return runScoringSweep(sweepSpec, sweepThreads, filterNeutralized);
+
+  std::unique_ptr<PerfProfiler> profiler;
+  if (perfMode)
+    profiler.reset(new PerfProfiler());
+  PerfProfiler *perf = profiler.get();
+
+  SeasonManager season;
+  if (memoryBudgetMb > 0.0) {
+    season.setMemoryBudget((size_t)(memoryBudgetMb * 1024.0 * 1024.0));
+  }
+  season.enableAsyncExport("dashboard/data.js");
+  season.setBattleTracking(battles);
+  season.setNeutralizedLapFiltering(filterNeutralized);
+  season.setLeaderboardPublishing(readerThreads > 0);
+  LeaderboardReaders readers;
+  readers.start(season, readerThreads);
+
+  // What-if standings follow the season race by race (stored results only)
+  WhatIfStandings whatIf;
+  for (const std::string &spec : whatIfRules) {
+    PointsRules rules;
+    if (!PointsRules::preset(spec, rules)) {
+      Log::error() << "Unknown points rules: " << spec;
+      return 1;
+    }
+    whatIf.addRules(rules);
+  }
+  if (whatIf.getRuleCount() > 0) {
+    season.subscribeResults(
+        [&whatIf](const RaceResult &r) { whatIf.addRace(r); });
+    season.subscribeCorrections(
+        [&whatIf](const RaceResult &r) { whatIf.replaceRace(r); });
+  }
+
+  // Decisions wait until their race has a result
+  std::vector<ResultCorrection> pendingCorrections;
+  if (!correctionsFile.empty() &&
+      !loadCorrections(correctionsFile, pendingCorrections))
+    return 1;
+  auto applyDueCorrections = [&]() {
+    size_t kept = 0;
+    for (const ResultCorrection &c : pendingCorrections) {
+      bool ended = false;
+      for (const RaceResult &r : season.getSeasonHistory())
+        ended = ended || r.raceId == c.raceId;
+      if (ended)
+        season.applyCorrection(c);
+      else
+        pendingCorrections[kept++] = c;
+    }
+    pendingCorrections.resize(kept);
+  };
+
+  std::unique_ptr<NdjsonDeltaSink> deltaJson;
+  std::unique_ptr<BinaryDeltaSink> deltaBin;
+  if (!deltasFile.empty()) {
+    deltaJson.reset(new NdjsonDeltaSink(deltasFile));
+    if (!deltaJson->isOpen()) {
+      Log::error() << "Failed to open delta file: " << deltasFile;
+      return 1;
+    }
+    NdjsonDeltaSink *sink = deltaJson.get();
+    season.subscribeDeltas([sink](const LapDelta &d) { sink->write(d); });
+  }
+  if (!deltasBinFile.empty()) {
+    deltaBin.reset(new BinaryDeltaSink(deltasBinFile));
+    if (!deltaBin->isOpen()) {
+      Log::error() << "Failed to open delta file: " << deltasBinFile;
+      return 1;
+    }
+    BinaryDeltaSink *sink = deltaBin.get();
+    season.subscribeDeltas([sink](const LapDelta &d) { sink->write(d); });
+  }
+
+  int firstRace = 1;
+  bool resumed = false;
+  if (liveLag >= 0) {
+    season.loadDriversFromFile("data/drivers.txt");
+    season.loadIdealLapTimes("data/ideal_lap_times.txt");
+    season.setWatermarkLag(liveLag);
+
+    std::ifstream tape("data/race_events.txt");
+    if (!tape.is_open()) {
+      Log::error() << "Failed to open event file: data/race_events.txt";
+      return 1;
+    }
+    int liveRace = 0;
+    std::string line;
+    while (std::getline(tape, line)) {
+      season.parseEventLine(line, [&](int raceId, int lap,
+                                      const std::string &driverId,
+                                      const Event &ev) {
+        if (raceId != liveRace) {
+          if (liveRace > 0) {
+            season.finishLiveRace();
+            season.endRace();
+          }
+          Log::info() << "\nLIVE RACE " << raceId;
+          season.beginLiveRace(raceId);
+          liveRace = raceId;
+        }
+        season.ingestEvent(raceId, lap, driverId, ev);
+      });
+    }
+    if (liveRace > 0) {
+      season.finishLiveRace();
+      season.endRace();
+    }
+    firstRace = 6; // Season already streamed
+  } else if (!resumeFile.empty() && season.loadSnapshot(resumeFile)) {
+    resumed = true;
+    whatIf.addRaces(season.getSeasonHistory());
+  } else {
+    profiled(perf, "load", [&] {
+      // Register Drivers from file
+      season.loadDriversFromFile("data/drivers.txt");
+      season.loadIdealLapTimes("data/ideal_lap_times.txt");
+
+      // Load Race Events (selected races are parsed on demand by startRace)
+      if (!selectedRaces.empty()) {
+        season.openRaceEvents("data/race_events.txt");
+      } else if (loadThreads > 1) {
+        season.loadRaceEventsParallel("data/race_events.txt", loadThreads);
+      } else {
+        season.loadRaceEvents("data/race_events.txt");
+      }
+    });
+  }
+
+  applyDueCorrections(); // Races already streamed or restored
+
+  if (!samplesFile.empty()) {
+    long long loaded = season.loadTelemetrySamples(samplesFile);
+    if (loaded < 0)
+      return 1;
+    Log::info() << "Telemetry samples loaded: " << loaded;
+  }
+
+  std::vector<int> racesToRun;
+  if (liveLag < 0 && !selectedRaces.empty()) {
+    racesToRun = selectedRaces;
+  } else {
+    for (int race = firstRace; race <= 5; ++race)
+      racesToRun.push_back(race);
+  }
+  if (resumed) {
+    // Every race without a result, not just those after the last one run
+    // (a --races run may have skipped some)
+    std::vector<int> remaining;
+    for (int race : racesToRun) {
+      bool done = false;
+      for (const RaceResult &r : season.getSeasonHistory())
+        done = done || r.raceId == race;
+      if (done)
+        Log::info() << "Race " << race << " already in the snapshot";
+      else
+        remaining.push_back(race);
+    }
+    racesToRun = remaining;
+  }
+
+  Log::info() << "Drivers and Events Registered.";
 
   // Simulate Season (5 Races)
-  for (int race = 1; race <= 5; ++race) {
-    std::cout << "\n===================================" << std::endl;
-    std::cout << "STARTING RACE " << race << std::endl;
-    std::cout << "===================================" << std::endl;
+  for (int race : racesToRun) {
+    Log::info() << "\n===================================";
+    Log::info() << "STARTING RACE " << race;
+    Log::info() << "===================================";
 
     // Dynamic Lap Count
     int totalLaps = season.getRaceLapCount(race);
-    std::cout << "Simulating " << totalLaps << " Laps..." << std::endl;
+    Log::info() << "Simulating " << totalLaps << " Laps...";
 
-    // Process Grid/Tyre Events (Lap 0) - Critical for Participation Check
-    season.startRace(race);
-    season.processRaceLap(race, 0); // Still process for Tyre compound init
+    if (batchMode) {
+      profiled(perf, "batchRace", [&] { season.runRaceBatch(race); });
+    } else {
+      // Process Grid/Tyre Events (Lap 0) - Critical for Participation Check
+      profiled(perf, "startRace", [&] { season.startRace(race); });
 
-    for (int lap = 1; lap <= totalLaps; ++lap) {
-      season.processRaceLap(race, lap);
+      // Lap 0 is still processed for Tyre compound init
+      for (int lap = 0; lap <= totalLaps; ++lap) {
+        if (!perf) {
+          season.processRaceLap(race, lap);
+          continue;
+        }
+        PerfReading started = perf->begin();
+        season.processRaceLap(race, lap);
+        perf->endLap(started, race, lap, season.getLapEventCount(race, lap));
+      }
     }
 
     // End Race (Prints results and assigns points)
-    season.endRace();
+    profiled(perf, "endRace", [&] { season.endRace(); });
+    applyDueCorrections();
+
+    if (!snapshotFile.empty()) {
+      season.saveSnapshot(snapshotFile);
+    }
   }
 
+  if (readerThreads > 0) {
+    readers.stop();
+    LeaderboardSnapshot last = season.getLeaderboardSnapshot();
+    Log::info() << "\nLEADERBOARD READERS\n"
+                << readerThreads << " threads, " << readers.getReads()
+                << " reads, newest version seen " << readers.getNewestSeen()
+                << " of " << last.version << ", "
+                << readers.getInconsistent() << " inconsistent";
+  }
+
+  for (const ResultCorrection &c : pendingCorrections)
+    Log::warn() << "Correction " << c.describe() << " for " << c.driverId
+                << " not applied: race " << c.raceId << " was not run";
+
   // Final Season Standings
-  std::cout << "\n\n###################################" << std::endl;
-  std::cout << "FINAL SEASON STANDINGS" << std::endl;
-  std::cout << "###################################" << std::endl;
+  Log::info() << "\n\n###################################";
+  Log::info() << "FINAL SEASON STANDINGS";
+  Log::info() << "###################################";
 
   std::vector<Driver *> standings = season.getSeasonStandings();
   for (int i = 0; i < standings.size(); ++i) {
     Driver *d = standings[i];
-    std::cout << (i + 1) << ". " << d->getName() << " [" << d->getTeam()
-              << "] - " << d->getSeasonPoints()
-              << " PTS [Total Time: " << std::fixed << std::setprecision(2)
-              << d->getSeasonTotalTime() << "s]" << std::endl;
+    Log::info() << (i + 1) << ". " << d->getName() << " [" << d->getTeam()
+                << "] - " << d->getSeasonPoints()
+                << " PTS [Total Time: " << std::fixed << std::setprecision(2)
+                << d->getSeasonTotalTime() << "s]";
   }
 
   // Export Results
-  season.exportSeasonToJson("dashboard/data.js");
+  profiled(perf, "export", [&] {
+    season.flushExport(true);
+    if (!samplesFile.empty())
+      season.exportSamplesCsv("dashboard/samples.csv", 500);
+    // Per-race analytics are not in snapshots: after a resume they only
+    // cover part of the season, so the previous files are kept
+    if (resumed) {
+      Log::info() << "Resumed from a snapshot: pace, gap, telemetry, tyre, "
+                     "battle and anomaly exports skipped";
+      return;
+    }
+    season.exportPaceStatsCsv("dashboard/pace_stats.csv");
+    season.exportGapsCsv("dashboard/gaps.csv");
+    season.exportDegradationCsv("dashboard/degradation.csv");
+    season.exportLapTelemetryJs("dashboard/laps.js");
+    if (battles)
+      season.exportBattlesCsv("dashboard/battles.csv");
+    if (filterNeutralized)
+      season.exportLapAnomaliesCsv("dashboard/anomalies.csv");
+  });
+
+  if (filterNeutralized) {
+    Log::info() << "\nNEUTRALIZED LAPS";
+    for (const RaceResult &race : season.getSeasonHistory()) {
+      const LapAnomalyDetector *detector =
+          season.getLapAnomalies(race.raceId);
+      if (!detector)
+        continue;
+      std::ostringstream line;
+      int outliers = 0, start = -1;
+      const std::vector<LapAnomaly> &laps = detector->getLaps();
+      for (size_t lap = 0; lap <= laps.size(); ++lap) {
+        bool flagged = lap < laps.size() && laps[lap].neutralized;
+        if (lap < laps.size())
+          outliers += (int)laps[lap].outliers.size();
+        if (flagged && start < 0)
+          start = (int)lap;
+        if (!flagged && start >= 0) {
+          line << " " << start;
+          if ((int)lap - 1 > start)
+            line << "-" << (lap - 1);
+          start = -1;
+        }
+      }
+      std::string ranges = line.str();
+      Log::info() << "Race " << race.raceId << ":"
+                  << (ranges.empty() ? " none" : ranges) << " (" << outliers
+                  << " slow outlier laps)";
+    }
+  }
+
+  if (battles) {
+    Log::info() << "\nTEAMMATE BATTLES (laps ahead / overtakes)";
+    const BattleMatrix &m = season.getSeasonBattles();
+    m.forEachTeammatePair([&](int a, int b, const BattleRecord &r) {
+      Log::info() << std::left << std::setw(16) << m.getTeam(a) << m.getId(a)
+                  << " " << r.lapsAhead << "-" << r.lapsBehind << " "
+                  << m.getId(b) << "  (" << r.overtakesGained << "-"
+                  << r.overtakesLost << ")";
+    });
+  }
+
+  if (whatIf.getRuleCount() > 0) {
+    std::ostringstream table;
+    whatIf.printComparison(table);
+    std::string text = table.str();
+    if (!text.empty() && text.back() == '\n')
+      text.pop_back();
+    Log::info() << "\nWHAT-IF STANDINGS\n" << text;
+  }
+
+  if (perf) {
+    std::ostringstream report;
+    perf->print(report);
+    std::string text = report.str();
+    if (!text.empty() && text.back() == '\n')
+      text.pop_back();
+    Log::info() << "\nPERFORMANCE COUNTERS\n" << text;
+    if (!perfLapsFile.empty()) {
+      if (perf->exportLapsCsv(perfLapsFile)) {
+        Log::info() << "Per-lap counters exported to " << perfLapsFile;
+      } else {
+        Log::error() << "Failed to write " << perfLapsFile;
+      }
+    }
+  }
+
+  if (memoryReport) {
+    std::ostringstream report;
+    season.memoryReport().print(report);
+    std::string text = report.str();
+    if (!text.empty() && text.back() == '\n')
+      text.pop_back();
+    Log::info() << "\nMEMORY USAGE\n" << text;
+  }
 
   return 0;
 }